@@ -0,0 +1,81 @@
+/********************************************************************************************//**
+ * @file atom.cc
+ *
+ * class Atom implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "atom.h"
+
+#include <deque>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+	/// The atom table; strings, indexed by id, and ids, indexed by string
+	struct AtomTable {
+		deque<string>					strings;
+		unordered_map<string, uint32_t>	ids;
+
+		AtomTable() {
+			strings.push_back("");
+			ids.insert({ "", 0 });
+		}
+	};
+
+	/// Return the atom table, constructing it on first use
+	AtomTable& table() {
+		static AtomTable atoms;
+		return atoms;
+	}
+}
+
+/************************************************************************************************
+ * class Atom
+ ************************************************************************************************/
+
+// public
+
+/********************************************************************************************//**
+ * @param	s	The string to intern
+ ************************************************************************************************/
+Atom::Atom(const string& s) {
+	AtomTable& atoms = table();
+	auto it = atoms.ids.find(s);
+	if (it == atoms.ids.end()) {
+		it = atoms.ids.insert({ s, static_cast<uint32_t>(atoms.strings.size()) }).first;
+		atoms.strings.push_back(s);
+	}
+
+	_id = it->second;
+}
+
+/********************************************************************************************//**
+ * @return The string I represent
+ ************************************************************************************************/
+const string& Atom::str() const {
+	return table().strings[_id];
+}
+
+// public static
+
+/********************************************************************************************//**
+ * @return The number of distinct atoms, including the empty string
+ ************************************************************************************************/
+size_t Atom::size() {
+	return table().strings.size();
+}
+
+// operators
+
+/********************************************************************************************//**
+ * @param	os		The stream to write atom on
+ * @param	atom	The atom to write
+ * @return	os
+ ************************************************************************************************/
+ostream& operator<<(ostream& os, Atom atom) {
+	return os << atom.str();
+}
@@ -0,0 +1,56 @@
+/********************************************************************************************//**
+ * @file atom.h
+ *
+ * class Atom, an interned identifier.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	ATOM_H
+#define	ATOM_H
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+
+/********************************************************************************************//**
+ * An interned identifier
+ *
+ * Each distinct string is stored once, in a global table, and is represented by it's 32-bit
+ * index into that table. Thus atoms are compared, and hashed, as integers. Atoms are never
+ * released; the default atom is the empty string.
+ ************************************************************************************************/
+class Atom {
+public:
+	Atom() : _id{0} {}							///< The empty string
+	explicit Atom(const std::string& s);		///< Intern s...
+
+	uint32_t id() const							{	return _id;			}	///< Return my id
+	bool empty() const							{	return 0 == _id;	}	///< Am I ""?
+	const std::string& str() const;				///< Return my string
+
+	/// Return my string...
+	operator const std::string&() const			{	return str();		}
+
+	static size_t size();						///< Return the number of atoms
+
+private:
+	uint32_t	_id;							///< Index into the atom table
+};
+
+inline bool operator==(Atom lhs, Atom rhs)		{	return lhs.id() == rhs.id();	}
+inline bool operator!=(Atom lhs, Atom rhs)		{	return lhs.id() != rhs.id();	}
+inline bool operator<(Atom lhs, Atom rhs)		{	return lhs.id() < rhs.id();		}
+
+std::ostream& operator<<(std::ostream& os, Atom atom);
+
+namespace std {
+	/// Hash an Atom by it's id
+	template<> struct hash<Atom> {
+		size_t operator()(Atom atom) const		{	return atom.id();	}
+	};
+}
+
+#endif
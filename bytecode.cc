@@ -0,0 +1,262 @@
+/********************************************************************************************//**
+ * @file bytecode.cc
+ *
+ * class Bytecode implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "bytecode.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static_assert(sizeof(Bytecode::Header) % alignof(Bytecode::Record) == 0, "misaligned records");
+static_assert(sizeof(Bytecode::Record) == 16, "unexpected record size");
+
+/************************************************************************************************
+ * class Bytecode
+ ************************************************************************************************/
+
+// private
+
+/********************************************************************************************//**
+ * @param	msg	Why the operation failed
+ * @return	false
+ ************************************************************************************************/
+bool Bytecode::fail(const string& msg) {
+	_error = msg;
+	return false;
+}
+
+/********************************************************************************************//**
+ * @param	fName	The file name, for error messages
+ * @param	header	The file's header
+ * @param	key		The required source key, or zero for any key
+ * @param	nBytes	The size of the file following the header
+ *
+ * @return	false, and error() is set, if the header isn't valid
+ ************************************************************************************************/
+bool Bytecode::check(const string& fName, const Header& header, uint64_t key, size_t nBytes) {
+	if (header.magic != magic)
+		return fail(fName + " is not a P bytecode file");
+
+	if (header.format != format)
+		return fail(fName + " has an unsupported format");
+
+	if (string(header.version, strnlen(header.version, sizeof header.version)) != version)
+		return fail(fName + " was written by another compiler version");
+
+	if (key != 0 && header.key != key)
+		return fail(fName + " is out of date");
+
+	if (nBytes < header.nCode * sizeof(Record) + header.nIndex * sizeof(uint32_t))
+		return fail(fName + " is truncated");
+
+	return true;
+}
+
+// public static
+
+/********************************************************************************************//**
+ * @param	s	The string to hash
+ * @param	h	The hash so far
+ * @return	s's FNV-1a hash, continued from h
+ ************************************************************************************************/
+uint64_t Bytecode::hash(const string& s, uint64_t h) {
+	for (unsigned char c : s) {
+		h ^= c;
+		h *= 0x100000001b3ULL;
+	}
+
+	return h;
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	version	The compiler version written to, and required of, .pbc files
+ ************************************************************************************************/
+Bytecode::Bytecode(const string& version)
+	: version{version}, base{nullptr}, length{0}, _records{nullptr}, nRecords{0}
+{
+}
+
+/********************************************************************************************//**
+ * The file is written to a temporary file, named for this process, and then renamed, so that
+ * concurrent readers never see a partial file, nor do concurrent writers share a temporary.
+ *
+ * @param	fName	The file name
+ * @param	key		The source key
+ * @param	code	The code to write
+ * @param	index	code's source cross index
+ *
+ * @return	false, and error() is set, if the file couldn't be written
+ ************************************************************************************************/
+bool Bytecode::write(const string& fName, uint64_t key, const InstrVector& code, const SourceIndex& index) {
+	Header header;
+	memset(&header, 0, sizeof header);
+	header.magic = magic;
+	header.format = format;
+	strncpy(header.version, version.c_str(), sizeof header.version - 1);
+	header.key = key;
+	header.nCode = code.size();
+	header.nIndex = index.size();
+
+	vector<Record> records(code.size());
+	for (size_t pc = 0; pc < code.size(); ++pc) {
+		const Instr& instr = code[pc];
+		Record& r = records[pc];
+		memset(&r, 0, sizeof r);
+		r.op = static_cast<uint8_t>(instr.op);
+		r.level = instr.level;
+		r.kind = static_cast<uint8_t>(instr.value.kind());
+
+		switch(instr.value.kind()) {
+		case Datum::Boolean:	r.value = instr.value.boolean();					break;
+		case Datum::Character:	r.value = instr.value.character();					break;
+		case Datum::Integer:	r.value = static_cast<int64_t>(instr.value.integer());	break;
+		case Datum::Real: {
+			const double d = instr.value.real();
+			memcpy(&r.value, &d, sizeof d);
+			break;
+		}
+		}
+	}
+
+	vector<uint32_t> lines(index.begin(), index.end());
+
+	const string temp = fName + "." + to_string(getpid()) + ".tmp";	// Unique to this process
+	ofstream out(temp, ios::binary);
+	if (!out.is_open())
+		return fail("can't create " + temp);
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof header);
+	out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+	out.write(reinterpret_cast<const char*>(lines.data()), lines.size() * sizeof(uint32_t));
+	out.close();
+
+	if (!out) {
+		remove(temp.c_str());
+		return fail("error writing " + temp);
+	}
+
+	if (0 != rename(temp.c_str(), fName.c_str())) {
+		remove(temp.c_str());
+		return fail("can't rename " + temp + " to " + fName);
+	}
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * @param			fName	The file name
+ * @param			key		The required source key, or zero for any key
+ * @param[out]		code	The code read
+ * @param[out]		index	code's source cross index
+ *
+ * @return	false, and error() is set, if the file doesn't exist, isn't a valid .pbc file, was
+ * 			written by another version of the compiler, or has the wrong key.
+ ************************************************************************************************/
+bool Bytecode::read(const string& fName, uint64_t key, InstrVector& code, SourceIndex& index) {
+	ifstream in(fName, ios::binary);
+	if (!in.is_open())
+		return fail("can't open " + fName);
+
+	in.seekg(0, ios::end);
+	const streamoff size = in.tellg();
+	in.seekg(0, ios::beg);
+
+	Header header;
+	if (!in.read(reinterpret_cast<char*>(&header), sizeof header))
+		return fail(fName + " is not a P bytecode file");
+
+	if (!check(fName, header, key, static_cast<size_t>(size) - sizeof header))
+		return false;
+
+	vector<Record> records(header.nCode);
+	vector<uint32_t> lines(header.nIndex);
+	in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(Record));
+	in.read(reinterpret_cast<char*>(lines.data()), lines.size() * sizeof(uint32_t));
+	if (!in)
+		return fail(fName + " is truncated");
+
+	InstrVector	prog;
+	prog.reserve(records.size());
+	for (const auto& r : records) {
+		if (r.op > static_cast<uint8_t>(OpCode::HALT))
+			return fail(fName + " has an invalid opcode");
+
+		if (r.kind > Datum::Real)
+			return fail(fName + " has an invalid value");
+
+		prog.push_back(Instr());
+		decode(r, prog.back());
+	}
+
+	code.swap(prog);
+	index.assign(lines.begin(), lines.end());
+	return true;
+}
+
+/********************************************************************************************//**
+ * Any previous mapping is released first. Only the header is validated; the records are left
+ * to the machine.
+ *
+ * @param	fName	The file name
+ * @param	key		The required source key, or zero for any key
+ *
+ * @return	false, and error() is set, if the file can't be mapped, or it's header isn't valid
+ ************************************************************************************************/
+bool Bytecode::map(const string& fName, uint64_t key) {
+	unmap();
+
+	const int fd = open(fName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return fail("can't open " + fName);
+
+	struct stat st;
+	if (0 != fstat(fd, &st) || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+		close(fd);
+		return fail(fName + " is not a P bytecode file");
+	}
+
+	void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);									// the mapping holds it's own reference
+	if (MAP_FAILED == p)
+		return fail("can't map " + fName);
+
+	base = p;
+	length = st.st_size;
+
+	const Header& header = *static_cast<const Header*>(base);
+	if (!check(fName, header, key, length - sizeof header)) {
+		unmap();
+		return false;
+	}
+
+	_records = reinterpret_cast<const Record*>(static_cast<const char*>(base) + sizeof header);
+	nRecords = header.nCode;
+	return true;
+}
+
+/********************************************************************************************//**
+ ************************************************************************************************/
+void Bytecode::unmap() {
+	if (base != nullptr)
+		munmap(base, length);
+
+	base = nullptr;
+	length = 0;
+	_records = nullptr;
+	nRecords = 0;
+}
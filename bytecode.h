@@ -0,0 +1,138 @@
+/********************************************************************************************//**
+ * @file bytecode.h
+ *
+ * class Bytecode, the compiled program (.pbc) file format.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	BYTECODE_H
+#define	BYTECODE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "instr.h"
+
+/********************************************************************************************//**
+ * A compiled program file
+ *
+ * A .pbc file is a Header, followed by nCode fixed size Records, one per instruction, followed
+ * by nIndex 32-bit source line numbers, indexed by instruction address. Constants are the values
+ * of the instructions that push them, so there's no separate constant pool. Values are written in
+ * the host's byte order; a file written on a host of the other order fails the magic check.
+ *
+ * Opcodes are renumbered as the machine evolves, so a file is only loaded by the compiler
+ * version that wrote it. The header also records a key, a hash of the source, the compiler
+ * version and it's options, used by the compile cache.
+ *
+ * A file may be read, into an InstrVector, or mapped read-only, and executed in place via
+ * records(); the Header's size keeps the Records aligned. Processes that map the same file
+ * share it's pages, and mapping doesn't visit the records, so it's cost is independent of the
+ * size of the program. The machine validates each instruction as it's fetched.
+ ************************************************************************************************/
+class Bytecode {
+public:
+	/// A table, indexed by instruction address, yeilding source line numbers...
+	typedef std::vector<unsigned> SourceIndex;
+
+	static const uint32_t	magic = 0x0a434250;	///< "PBC\n", in little endian order
+	static const uint32_t	format = 2;			///< The file format version
+
+	/// The file header
+	struct Header {
+		uint32_t	magic;						///< Bytecode::magic
+		uint32_t	format;						///< Bytecode::format
+		char		version[16];				///< Compiler version, nul padded
+		uint64_t	key;						///< Source, version and options hash
+		uint32_t	nCode;						///< Number of instructions
+		uint32_t	nIndex;						///< Number of source line numbers
+	};
+
+	/// An instruction
+	struct Record {
+		uint8_t		op;							///< The OpCode
+		int8_t		level;						///< The level
+		uint8_t		kind;						///< The value's Datum::Kind
+		uint8_t		pad[5];						///< Reserved, zero
+		uint64_t	value;						///< The value; an integer, or a real's bits
+	};
+
+	Bytecode(const std::string& version);		///< Constructor
+	Bytecode(const Bytecode&) = delete;			///< No copies; I may own a mapping
+	Bytecode& operator=(const Bytecode&) = delete;	///< No copies; I may own a mapping
+	virtual ~Bytecode()							{	unmap();	}
+
+	/// Return the FNV-1a hash of s, continuing from h...
+	static uint64_t hash(const std::string& s, uint64_t h = 0xcbf29ce484222325ULL);
+
+	/// Write code, and it's source index, to fName...
+	bool write(			const std::string&	fName,
+						uint64_t			key,
+				const	InstrVector&		code,
+				const	SourceIndex&		index);
+
+	/// Read code, and it's source index, from fName...
+	bool read(			const std::string&	fName,
+						uint64_t			key,
+						InstrVector&		code,
+						SourceIndex&		index);
+
+	/// Map fName read-only...
+	bool map(const std::string& fName, uint64_t key);
+	void unmap();								///< Release the mapping, if any
+
+	/// Return the mapped instructions, or nullptr if nothing is mapped
+	const Record* records() const				{	return _records;	}
+
+	/// Return the number of mapped instructions
+	size_t size() const							{	return nRecords;	}
+
+	/// Decode r into instr...
+	static void decode(const Record& r, Instr& instr);
+
+	/// Return the reason the last read, write or map failed
+	const std::string& error() const			{	return _error;	}
+
+private:
+	std::string			version;				///< The compiler version
+	std::string			_error;					///< Why the last read, write or map failed
+	void*				base;					///< The mapped file, or nullptr
+	size_t				length;					///< The size of the mapping
+	const Record*		_records;				///< The mapped instructions
+	size_t				nRecords;				///< The number of mapped instructions
+
+	bool fail(const std::string& msg);			///< Note why an operation failed...
+
+	/// Validate header as that of fName, with nBytes of content...
+	bool check(const std::string& fName, const Header& header, uint64_t key, size_t nBytes);
+};
+
+/********************************************************************************************//**
+ * Records with an invalid kind yield an Integer; the value's bits are used as is. Inline, as the
+ * machine decodes each mapped instruction as it's fetched.
+ *
+ * @param		r		The record to decode
+ * @param[out]	instr	r as an Instr
+ ************************************************************************************************/
+inline void Bytecode::decode(const Record& r, Instr& instr) {
+	instr.op = static_cast<OpCode>(r.op);
+	instr.level = r.level;
+
+	switch(r.kind) {
+	case Datum::Boolean:	instr.value = r.value != 0;								break;
+	case Datum::Character:	instr.value = static_cast<char>(r.value);				break;
+	case Datum::Real: {
+		double d;
+		std::memcpy(&d, &r.value, sizeof d);
+		instr.value = d;
+		break;
+	}
+	default:				instr.value = static_cast<int>(static_cast<int64_t>(r.value));
+	}
+}
+
+#endif
@@ -0,0 +1,261 @@
+/********************************************************************************************//**
+ * @file cfg.cc
+ *
+ * class CFG implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "cfg.h"
+
+#include <cassert>
+#include <limits>
+
+using namespace std;
+
+/************************************************************************************************
+ * class CFG
+ ************************************************************************************************/
+
+// public static
+
+const size_t CFG::none = numeric_limits<size_t>::max();
+
+/********************************************************************************************//**
+ * @param	op	The operation code
+ * @return	true if op is CALLI, TCALLI, JUMPI, JNEQI or FORNEXT
+ ************************************************************************************************/
+bool CFG::isBranch(OpCode op) {
+	switch(op) {
+	case OpCode::CALLI:
+	case OpCode::TCALLI:
+	case OpCode::JUMPI:
+	case OpCode::JNEQI:
+	case OpCode::FORNEXT:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+// public
+
+/********************************************************************************************//**
+ * Code that uses computed addresses, e.g., JUMP or CALL, or that jumps outside of itself, can't
+ * be represented.
+ *
+ * @param	code	The code
+ * @param	index	code's source cross index
+ *
+ * @return	false if code can't be represented
+ ************************************************************************************************/
+bool CFG::build(const InstrVector& code, const SourceIndex& index) {
+	_blocks.clear();
+	if (code.empty())
+		return true;
+
+	vector<bool> leader(code.size(), false);	// Find the first instruction of each block
+	leader[0] = true;
+	for (size_t pc = 0; pc < code.size(); ++pc) {
+		const Instr& instr = code[pc];
+		switch(instr.op) {
+		case OpCode::CALL:
+		case OpCode::JUMP:
+		case OpCode::JNEQ:
+			return false;
+
+		case OpCode::TCALLI:
+		case OpCode::JUMPI:
+		case OpCode::JNEQI:
+		case OpCode::FORNEXT:
+		case OpCode::RET:
+		case OpCode::RETF:
+		case OpCode::HALT:
+			if (pc + 1 < code.size())
+				leader[pc + 1] = true;
+			break;
+
+		default:
+			;
+		}
+
+		if (isBranch(instr.op)) {
+			if (instr.value.natural() >= code.size())
+				return false;
+			leader[instr.value.natural()] = true;
+		}
+	}
+
+	vector<size_t> blockOf(code.size());		// Number the blocks
+	size_t n = 0;
+	for (size_t pc = 0; pc < code.size(); ++pc) {
+		if (leader[pc] && pc > 0)
+			++n;
+		blockOf[pc] = n;
+	}
+
+	_blocks.assign(n + 1, Block { InstrVector(), SourceIndex(), none, false });
+	for (size_t pc = 0; pc < code.size(); ++pc) {
+		Block& b = _blocks[blockOf[pc]];
+		Instr instr = code[pc];
+		if (isBranch(instr.op))
+			instr.value = blockOf[instr.value.natural()];
+
+		b.code.push_back(instr);
+		b.lines.push_back(pc < index.size() ? index[pc] : 0);
+	}
+
+	for (size_t i = 0; i + 1 < _blocks.size(); ++i) {
+		switch(_blocks[i].code.back().op) {
+		case OpCode::TCALLI:
+		case OpCode::JUMPI:
+		case OpCode::RET:
+		case OpCode::RETF:
+		case OpCode::HALT:
+			break;								// No fall through
+
+		default:
+			_blocks[i].next = i + 1;
+		}
+	}
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * @param[out]	code	The lowered code
+ * @param[out]	index	code's source cross index
+ ************************************************************************************************/
+void CFG::lower(InstrVector& code, SourceIndex& index) const {
+	vector<Block> laid;							// The surviving blocks, in order, and...
+	vector<size_t> number;						// ...their block numbers
+	for (size_t i = 0; i < _blocks.size(); ++i)
+		if (!_blocks[i].removed) {
+			laid.push_back(_blocks[i]);
+			number.push_back(i);
+		}
+
+	vector<size_t> addr(_blocks.size(), 0);		// Finalize each block, and assign addresses
+	size_t pc = 0;
+	for (size_t i = 0; i < laid.size(); ++i) {
+		Block& b = laid[i];
+		const size_t following = i + 1 < laid.size() ? number[i + 1] : none;
+
+		if (!b.code.empty() && b.code.back().op == OpCode::JUMPI
+				&& b.code.back().value.natural() == following) {
+			b.code.pop_back();
+			b.lines.pop_back();
+
+		} else if (b.next != none && b.next != following) {
+			b.code.push_back(Instr(OpCode::JUMPI, 0, Datum(b.next)));
+			b.lines.push_back(b.lines.empty() ? 0 : b.lines.back());
+		}
+
+		addr[number[i]] = pc;
+		pc += b.code.size();
+	}
+
+	code.clear();
+	index.clear();
+	for (const auto& b : laid) {
+		for (size_t j = 0; j < b.code.size(); ++j) {
+			Instr instr = b.code[j];
+			if (isBranch(instr.op)) {
+				assert(!_blocks[instr.value.natural()].removed);
+				instr.value = addr[instr.value.natural()];
+			}
+
+			code.push_back(instr);
+			index.push_back(b.lines[j]);
+		}
+	}
+}
+
+/********************************************************************************************//**
+ * @param	b	The block number
+ * @return	b's successors
+ ************************************************************************************************/
+vector<size_t> CFG::successors(size_t b) const {
+	vector<size_t> succs;
+	for (const auto& instr : _blocks[b].code)
+		if (isBranch(instr.op) && !isCall(instr.op))
+			succs.push_back(instr.value.natural());
+
+	if (_blocks[b].next != none)
+		succs.push_back(_blocks[b].next);
+
+	return succs;
+}
+
+/********************************************************************************************//**
+ * The entry block is referenced by the machine.
+ *
+ * @return	The number of references to each block, indexed by block number
+ ************************************************************************************************/
+vector<unsigned> CFG::references() const {
+	vector<unsigned> refs(_blocks.size(), 0);
+	if (!refs.empty())
+		refs[0] = 1;
+
+	for (const auto& b : _blocks) {
+		if (b.removed)
+			continue;
+
+		for (const auto& instr : b.code)
+			if (isBranch(instr.op))
+				++refs[instr.value.natural()];
+
+		if (b.next != none)
+			++refs[b.next];
+	}
+
+	return refs;
+}
+
+/********************************************************************************************//**
+ * @return	The number of instructions in the surviving blocks
+ ************************************************************************************************/
+size_t CFG::nInstrs() const {
+	size_t n = 0;
+	for (const auto& b : _blocks)
+		if (!b.removed)
+			n += b.code.size();
+
+	return n;
+}
+
+/********************************************************************************************//**
+ * A procedure is the program entry, or a CALLI or TCALLI target, and the blocks reachable from it without
+ * following calls. A block reachable from more than one entry belongs to the first.
+ *
+ * @return	The entry block of each block's procedure, or none if the block is unreachable
+ ************************************************************************************************/
+vector<size_t> CFG::procedures() const {
+	vector<size_t> owner(_blocks.size(), none);
+	if (_blocks.empty())
+		return owner;
+
+	vector<size_t> entries { 0 };				// The program, and each called procedure
+	for (const auto& b : _blocks)
+		for (const auto& instr : b.code)
+			if (isCall(instr.op))
+				entries.push_back(instr.value.natural());
+
+	for (auto e : entries) {
+		vector<size_t> work { e };				// Claim the unclaimed blocks reachable from e
+		while (!work.empty()) {
+			const size_t b = work.back();
+			work.pop_back();
+			if (owner[b] != none)
+				continue;
+
+			owner[b] = e;
+			for (auto s : successors(b))
+				work.push_back(s);
+		}
+	}
+
+	return owner;
+}
@@ -0,0 +1,79 @@
+/********************************************************************************************//**
+ * @file cfg.h
+ *
+ * class CFG, the optimizer's intermediate representation; a control flow graph of basic blocks.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	CFG_H
+#define	CFG_H
+
+#include <cstddef>
+#include <vector>
+
+#include "instr.h"
+
+/********************************************************************************************//**
+ * A control flow graph
+ *
+ * Built from emitted code, optimized by passes, and then lowered back into code. Each basic
+ * block is a straight line sequence of instructions, entered only at it's first; blocks begin at
+ * the program entry, at each jump or call target, and following each JUMPI, JNEQI, FORNEXT, RET,
+ * RETF and HALT. Within the graph, the values of CALLI, JUMPI, JNEQI and FORNEXT instructions are
+ * block numbers, rather than addresses, so passes may add, remove, or move instructions freely.
+ *
+ * Fall through is explicit; a block's next member names the block that follows it, if any.
+ * Lowering lays out the blocks in order, skipping removed blocks, adding a JUMPI where a block's
+ * next block isn't the one laid out after it, and dropping a JUMPI to the block that follows.
+ ************************************************************************************************/
+class CFG {
+public:
+	/// A table, indexed by instruction address, yeilding source line numbers...
+	typedef std::vector<unsigned> SourceIndex;
+
+	static const size_t none;					///< No block
+
+	/// A basic block
+	struct Block {
+		InstrVector		code;					///< The instructions
+		SourceIndex		lines;					///< Source line number of each instruction
+		size_t			next;					///< The fall through successor, or none
+		bool			removed;				///< Removed from the program?
+	};
+
+	typedef std::vector<Block>	BlockVec;		///< A vector of blocks
+
+	/// Is op's value an address, i.e., a block number in the graph?
+	static bool isBranch(OpCode op);
+
+	/// Is op's value a procedure entry point, i.e., CALLI or TCALLI?
+	static bool isCall(OpCode op)				{	return op == OpCode::CALLI || op == OpCode::TCALLI;	}
+
+	/// Build the graph from code, and it's source index...
+	bool build(const InstrVector& code, const SourceIndex& index);
+
+	/// Lower the graph into code, and it's source index...
+	void lower(InstrVector& code, SourceIndex& index) const;
+
+	BlockVec& blocks()							{	return _blocks;	}	///< Return my blocks
+	const BlockVec& blocks() const				{	return _blocks;	}	///< Return my blocks
+
+	/// Return the successors of block b; it's jump targets and next block. Calls return, so
+	/// call targets aren't included.
+	std::vector<size_t> successors(size_t b) const;
+
+	/// Return the number of jumps, calls, and fall throughs, to each block...
+	std::vector<unsigned> references() const;
+
+	size_t nInstrs() const;						///< Return the number of instructions
+
+	/// Return the entry block of each block's procedure...
+	std::vector<size_t> procedures() const;
+
+private:
+	BlockVec		_blocks;					///< The blocks; 0 is the entry
+};
+
+#endif
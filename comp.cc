@@ -10,7 +10,10 @@
 #include "comp.h"
 #include "interp.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
@@ -43,6 +46,14 @@ bool PComp::isAReal(TDescPtr type) {
 	return	type->tclass() == TypeDesc::Real;
 }
 
+/********************************************************************************************//**
+ * @param	type	Type descriptor to investagate
+ * @return  true if type is a single ordinal value, rather than a reference, array or record
+ ************************************************************************************************/
+bool PComp::isScalar(TDescPtr type) {
+	return	!type->ref() && type->ordinal() && type->size() == 1;
+}
+
 /********************************************************************************************//**
  * @param	where	The jump to address, if known
  * @return  address	of the jump to address instruction, for patching when know
@@ -101,6 +112,183 @@ size_t PComp::emitCallI(int8_t level, size_t where) {
 	return emit(OpCode::CALLI, level, where);
 }
 
+/********************************************************************************************//**
+ * The last call emitted may reuse the caller's frame if it's the last instruction emitted, and
+ * it's callee isn't nested within the caller, as it would then reach the caller's frame via it's
+ * static link, and doesn't take var parameters, whose arguments could be the caller's variables.
+ * SLIDE moves Datums, while RET pops parameters, so both the callee's and the caller's
+ * parameters must be single Datums, e.g., not records, for the two to agree.
+ * CALLI level, addr becomes SLIDE m, n; TCALLI level, addr, where m and n are the callee's and
+ * the caller's number of parameters, and any jump to the end of the call, that was to
+ * whatever follows, e.g., the caller's return, now jumps past the TCALLI.
+ *
+ * @param	kind	The callee's kind; Procedure, if followed by a RET, or Function, a RETF
+ * @param	type	The caller's return type, that the callee's must match, if a function
+ * @param	caller	The caller
+ * @return	true if the call was rewritten
+ ************************************************************************************************/
+bool PComp::tailCall(SymValue::Kind kind, TDescPtr type, const SymValue& caller) {
+	if (!lastCall.tail || lastCall.pc + 1 != code->size() || lastCall.kind != kind
+			|| (kind == SymValue::Function && (lastCall.type != type || type->size() != 1)))
+		return false;
+
+	for (const auto& param : caller.params())
+		if (param->size() != 1)
+			return false;
+
+	const Instr call = (*code)[lastCall.pc];
+	const size_t end = lastCall.pc + 1;
+	retract(lastCall.pc);
+	emit(OpCode::SLIDE, lastCall.nParams, caller.params().size());
+	emit(OpCode::TCALLI, call.level, call.value);
+	for (auto& calls : unresolved)			// The call may still need patching
+		replace(calls.second.begin(), calls.second.end(), lastCall.pc, code->size() - 1);
+	replace(sites.begin(), sites.end(), lastCall.pc, code->size() - 1);
+
+	for (size_t pc = caller.value().natural(); pc < lastCall.pc; ++pc) {
+		Instr& instr = (*code)[pc];
+		if ((instr.op == OpCode::JUMPI || instr.op == OpCode::JNEQI || instr.op == OpCode::FORNEXT)
+				&& instr.value.natural() == end)
+			instr.value = code->size();
+	}
+
+	lastCall.tail = false;
+	return true;
+}
+
+/********************************************************************************************//**
+ * A subroutine may be inlined if it's parameters, and return value, are single Datums, and it's
+ * body, less any ENTER, is no longer than the limit, makes no calls, doesn't jump outside of
+ * itself, nor uses computed jumps.
+ *
+ * @param	sub		The subroutine
+ * @param	end		Address following sub's body
+ ************************************************************************************************/
+void PComp::inlinable(const SymValue& sub, size_t end) {
+	size_t begin = sub.value().natural();
+	int locals = 0;
+	if (begin < end && (*code)[begin].op == OpCode::ENTER) {
+		locals = (*code)[begin].value.integer();
+		++begin;
+	}
+
+	if (end - begin > (prof ? hotLimit * limit : limit)
+			|| (sub.kind() == SymValue::Function && sub.type()->size() != 1))
+		return;
+
+	for (const auto& param : sub.params())
+		if (!param->ref() && param->size() != 1)
+			return;
+
+	for (size_t pc = begin; pc < end; ++pc) {
+		const Instr& instr = (*code)[pc];
+		switch(instr.op) {
+		case OpCode::CALL:
+		case OpCode::CALLI:
+		case OpCode::TCALLI:
+		case OpCode::SLIDE:
+		case OpCode::JUMP:
+		case OpCode::JNEQ:
+		case OpCode::HALT:
+			return;
+
+		case OpCode::JUMPI:
+		case OpCode::JNEQI:
+		case OpCode::FORNEXT:
+			if (instr.value.natural() < begin || instr.value.natural() > end)
+				return;
+			break;
+
+		default:
+			;
+		}
+	}
+
+	bodies[&sub] = Body{begin, end, locals};
+}
+
+/********************************************************************************************//**
+ * Without a profile, or if the profile doesn't know the site, the limit is the limit. Given a
+ * profile, sites that were never reached aren't inlined, as it would only grow the code, and hot
+ * sites may inline subroutines hotLimit times larger.
+ *
+ * @param	site	The call site number
+ * @return	The size of the largest subroutine that may be inlined at site
+ ************************************************************************************************/
+unsigned PComp::siteLimit(size_t site) const {
+	uint64_t count = 0;
+	if (!prof || !prof->site(site, count))
+		return limit;
+
+	return 0 == count ? 0 : count >= Profile::hot ? hotLimit * limit : limit;
+}
+
+/********************************************************************************************//**
+ * The callee's arguments have been assigned to slots in the caller's frame, which are laid out
+ * like the callee's frame; the arguments are followed by an unused frame header, holding the
+ * return value, and the callee's locals. References to the callee's frame, including offsets
+ * folded into them, are relocated to the slots, references to it's enclosing frames are adjusted for the caller's depth, and returns jump
+ * to the end of the copy, which leaves the return value, if any, on the stack. The copy keeps the
+ * callee's source line numbers.
+ *
+ * @param	depth		Static depth of the callee from the caller; the CALLI level
+ * @param	body		The callee's body
+ * @param	slots		Offset of the first argument slot in the caller's frame
+ * @param	nParams		The callee's number of parameters
+ * @param	function	true if the callee is a function
+ ************************************************************************************************/
+void PComp::inlineBody(int depth, const Body& body, int slots, size_t nParams, bool function) {
+	const int m = nParams;
+	const size_t dst = code->size();
+	vector<size_t> exits;						// Jumps to the end of the copy
+
+	for (size_t pc = body.begin; pc < body.end; ++pc) {
+		Instr instr = (*code)[pc];
+		switch(instr.op) {
+		case OpCode::PUSHVAR:
+			if (instr.level == 0)
+				instr.value = slots + m + instr.value.integer();
+			else
+				instr.level = depth + instr.level - 1;
+			break;
+
+		case OpCode::JUMPI:
+		case OpCode::JNEQI:
+		case OpCode::FORNEXT:
+			if (instr.value.natural() == body.end)
+				exits.push_back(code->size());
+			else
+				instr.value = instr.value.natural() - body.begin + dst;
+			break;
+
+		case OpCode::RET:
+		case OpCode::RETF:
+			instr = Instr(OpCode::JUMPI, 0, Datum(0));
+			exits.push_back(code->size());
+			break;
+
+		default:
+			;
+		}
+
+		code->push_back(instr);
+		indextbl.push_back(pc < indextbl.size() ? indextbl[pc] : ts.lineNum);
+	}
+
+	if (!exits.empty() && exits.back() + 1 == code->size() && (*code)[exits.back()].op == OpCode::JUMPI) {
+		exits.pop_back();						// The last return falls through
+		code->pop_back();
+		indextbl.pop_back();
+	}
+	patch(exits, code->size());
+	target = max(target, code->size());		// The copy's jumps may target any of it
+
+	if (function) {
+		emit(OpCode::PUSHVAR, 0, slots + m + FrameRetVal);
+		emit(OpCode::EVAL, 0, 1);
+	}
+}
+
 /********************************************************************************************//**
  * Promote binary stack operands as necessary. 
  *
@@ -134,10 +322,13 @@ TDescPtr PComp::promote(TDescPtr lhs, TDescPtr rhs) {
  * Convert rhs of assign to real if necessary, or emit error would need to be
  * converted to an integer. 
  *
+ * Limit checks on a constant right-hand-side are resolved at compile time.
+ *
  * @param	lhs	The type of the left-hand-side
- * @param	rhs	The type of the right-hand-side 
+ * @param	rhs	The type of the right-hand-side
+ * @param	pc	Address of the first instruction of the right-hand-side
  ************************************************************************************************/
-void PComp::assignPromote (TDescPtr lhs, TDescPtr rhs) {
+void PComp::assignPromote (TDescPtr lhs, TDescPtr rhs, size_t pc) {
 	if (lhs->tclass() == rhs->tclass())
 		;				// nothing to do
 
@@ -155,9 +346,594 @@ void PComp::assignPromote (TDescPtr lhs, TDescPtr rhs) {
 		error("incompatable assignment types");
 
 	// Emit limit checks, unless range is impossible to exceed
-	if (lhs->ordinal() && lhs->range() != TypeDesc::maxRange) {
-		emit(OpCode::LLIMIT, 0, lhs->range().min());
-		emit(OpCode::ULIMIT, 0, lhs->range().max());
+	if (lhs->ordinal() && lhs->range() != TypeDesc::maxRange)
+		emitLimits(lhs->range(), pc);
+
+	fold(pc);
+}
+
+/********************************************************************************************//**
+ * Mirrors the machine's (PInterp) semantics for the operations that have no side effects, save
+ * for the stack. Operations that would fail at run time, e.g., divide by zero, out-of-range
+ * limit checks, or integer overflow, are not evaluated, so that the failure is left for the
+ * machine to report.
+ *
+ * @param	instr	The instruction to evaluate
+ * @param	stack	The evaluation stack
+ *
+ * @return	true if instr was evaluated
+ ************************************************************************************************/
+bool PComp::foldInstr(const Instr& instr, DatumVector& stack) {
+	const auto nElements = OpCodeInfo::info(instr.op).nElements();
+	if (instr.op != OpCode::PUSH && stack.size() < nElements)
+		return false;
+
+	// Integer results outside of an Integer's range aren't folded
+	auto fits = [](long long value) {
+		return value >= numeric_limits<int>::min() && value <= numeric_limits<int>::max();
+	};
+
+	try {
+		switch (instr.op) {
+		case OpCode::PUSH:
+			stack.push_back(instr.value);
+			return true;
+
+		case OpCode::NOT: {
+			Datum& TOS = stack.back();
+			if (TOS.kind() != Datum::Boolean)
+				return false;
+			TOS = !TOS.boolean();
+			return true;
+		}
+
+		case OpCode::LLIMIT:
+		case OpCode::ULIMIT: {				// TOS isn't consumed
+			const Datum& TOS = stack.back();
+			if (!TOS.ordinal())
+				return false;
+
+			Datum value = TOS;
+			if (TOS.kind() == Datum::Boolean)
+				value = Datum(TOS.boolean() ? 1 : 0);
+			else if (TOS.kind() == Datum::Character)
+				value = Datum(static_cast<size_t>(TOS.character()));
+
+			return instr.op == OpCode::LLIMIT ? !(value < instr.value) : !(value > instr.value);
+		}
+
+		default:
+			break;
+		}
+
+		if (nElements == 1) {				// Unary operations...
+			Datum& TOS = stack.back();
+			switch (instr.op) {
+			case OpCode::NEG:
+				if (!TOS.numeric() || (TOS.kind() == Datum::Integer && !fits(-1LL * TOS.integer())))
+					return false;
+				TOS = -TOS;
+				return true;
+
+			case OpCode::BNOT:
+				if (!TOS.numeric())
+					return false;
+				TOS = ~TOS;
+				return true;
+
+			case OpCode::ITOR:
+				if (TOS.kind() != Datum::Integer)
+					return false;
+				TOS = TOS.integer() * 1.0;
+				return true;
+
+			case OpCode::ROUND:
+			case OpCode::TRUNC: {
+				if (TOS.kind() != Datum::Real)
+					return false;
+				const double value = instr.op == OpCode::ROUND ? round(TOS.real()) : trunc(TOS.real());
+				if (!(value >= numeric_limits<int>::min() && value <= numeric_limits<int>::max()))
+					return false;
+				TOS = static_cast<int>(value);
+				return true;
+			}
+
+			case OpCode::ABS:
+				if (TOS.kind() == Datum::Integer && fits(llabs(TOS.integer())))
+					TOS = abs(TOS.integer());
+				else if (TOS.kind() == Datum::Real)
+					TOS = fabs(TOS.real());
+				else
+					return false;
+				return true;
+
+			case OpCode::SQR:
+				if (TOS.kind() == Datum::Integer && fits(1LL * TOS.integer() * TOS.integer()))
+					TOS = TOS.integer() * TOS.integer();
+				else if (TOS.kind() == Datum::Real)
+					TOS = TOS.real() * TOS.real();
+				else
+					return false;
+				return true;
+
+			case OpCode::ATAN:
+			case OpCode::EXP:
+			case OpCode::SIN:
+			case OpCode::SQRT: {
+				if (!TOS.numeric())
+					return false;
+				const double value = TOS.real();
+				TOS =	instr.op == OpCode::ATAN	? atan(value)	:
+						instr.op == OpCode::EXP		? exp(value)	:
+						instr.op == OpCode::SIN		? sin(value)	:
+													  sqrt(value);
+				return true;
+			}
+
+			case OpCode::LOG:
+				if (!TOS.numeric() || TOS.zero())
+					return false;
+				TOS = log(TOS.real());
+				return true;
+
+			case OpCode::ODD:
+				if (TOS.kind() != Datum::Integer)
+					return false;
+				TOS = (TOS.integer() & 1) ? true : false;
+				return true;
+
+			case OpCode::ORD:
+				if (TOS.kind() == Datum::Boolean)
+					TOS = TOS.boolean() ? 1 : 0;
+				else if (TOS.kind() == Datum::Character)
+					TOS = static_cast<int>(TOS.character());
+				else if (TOS.kind() != Datum::Integer)
+					return false;
+				return true;
+
+			case OpCode::PRED:
+				if (!TOS.numeric() || TOS <= instr.value)
+					return false;
+				--TOS;
+				return true;
+
+			case OpCode::SUCC:
+				if (!TOS.numeric() || TOS >= instr.value)
+					return false;
+				++TOS;
+				return true;
+
+			default:
+				return false;
+			}
+		}
+
+		if (nElements == 2) {				// Binary operations...
+			if (instr.op == OpCode::ITOR2) {
+				Datum& lhs = stack[stack.size() - 2];
+				if (lhs.kind() != Datum::Integer)
+					return false;
+				lhs = lhs.integer() * 1.0;
+				return true;
+			}
+
+			const Datum rhs = stack.back();
+			const Datum lhs = stack[stack.size() - 2];
+			Datum result;
+
+			const bool integers = lhs.kind() == Datum::Integer && rhs.kind() == Datum::Integer;
+			const long long l = integers ? lhs.integer() : 0;
+			const long long r = integers ? rhs.integer() : 0;
+
+			switch (instr.op) {
+			case OpCode::ADD:
+			case OpCode::SUB:
+			case OpCode::MUL:
+				if (!lhs.numeric() || !rhs.numeric())
+					return false;
+
+				else if (integers) {
+					const long long value =	instr.op == OpCode::ADD	? l + r	:
+											instr.op == OpCode::SUB	? l - r	:
+																	  l * r;
+					if (!fits(value))
+						return false;
+				}
+
+				result =	instr.op == OpCode::ADD	? lhs + rhs	:
+							instr.op == OpCode::SUB	? lhs - rhs	:
+													  lhs * rhs;
+				break;
+
+			case OpCode::DIV:
+				if (!lhs.numeric() || !rhs.numeric() || rhs.zero() || (integers && !fits(l / r)))
+					return false;
+				result = lhs / rhs;
+				break;
+
+			case OpCode::REM:
+				if (!integers || r == 0 || !fits(l / r))
+					return false;
+				result = lhs % rhs;
+				break;
+
+			case OpCode::BAND:	result = lhs & rhs;		break;
+			case OpCode::BOR:	result = lhs | rhs;		break;
+			case OpCode::BXOR:	result = lhs ^ rhs;		break;
+
+			case OpCode::SHIFTL:
+				if (!integers || l < 0 || r < 0 || r >= numeric_limits<int>::digits || !fits(l << r))
+					return false;
+				result = lhs << rhs;
+				break;
+
+			case OpCode::SHIFTR:
+				if (!integers || l < 0 || r < 0 || r >= numeric_limits<int>::digits)
+					return false;
+				result = lhs >> rhs;
+				break;
+
+			case OpCode::LT:
+			case OpCode::LTE:
+			case OpCode::EQU:
+			case OpCode::GTE:
+			case OpCode::GT:
+			case OpCode::NEQ:
+				if (!lhs.numeric() || !rhs.numeric())
+					return false;
+
+				switch (instr.op) {
+				case OpCode::LT:	result = Datum(lhs <  rhs);	break;
+				case OpCode::LTE:	result = Datum(lhs <= rhs);	break;
+				case OpCode::EQU:	result = Datum(lhs == rhs);	break;
+				case OpCode::GTE:	result = Datum(lhs >= rhs);	break;
+				case OpCode::GT:	result = Datum(lhs >  rhs);	break;
+				default:			result = Datum(lhs != rhs);	break;
+				}
+				break;
+
+			case OpCode::OR:
+			case OpCode::AND:
+				if (lhs.kind() != Datum::Boolean || rhs.kind() != Datum::Boolean)
+					return false;
+				result = Datum(instr.op == OpCode::OR ? lhs || rhs : lhs && rhs);
+				break;
+
+			default:
+				return false;
+			}
+
+			stack.pop_back();
+			stack.back() = result;
+			return true;
+		}
+
+	} catch (Result) {						// Datum operation failed; leave it for run time
+	}
+
+	return false;
+}
+
+/********************************************************************************************//**
+ * Evaluates the last operation emitted, and it's operands, code[start..], at compile time, where
+ * start is no earlier than pc. If every instruction could be evaluated, and the result is a single
+ * value, the instructions are replaced with a PUSH of that value.
+ *
+ * Operands are folded as they're emitted, so only the trailing instructions are evaluated, rather
+ * than all of code[pc..]. Nor is an operand that has already failed to fold evaluated again, as
+ * it would fail again, so a long expression is folded in linear time. The operands never span a
+ * jump target, e.g., the end of a short-circuit expression, as the jump would bypass the fold.
+ *
+ * @param	pc	Address of the first instruction of the (sub-)expression
+ *
+ * @return	true if code[start..] was replaced.
+ ************************************************************************************************/
+bool PComp::fold(size_t pc) {
+	if (pc >= code->size() || (code->size() - pc == 1 && (*code)[pc].op == OpCode::PUSH))
+		return false;						// nothing to fold
+
+	size_t start = code->size();			// Find the start of the last operation's operands...
+	for (int needed = 1; needed > 0; ) {
+		if (start == pc || start == unfoldable || start == target) {
+			unfoldable = code->size();		// Any operation using this result fails as well
+			return false;
+		}
+
+		const Instr& instr = (*code)[--start];
+		const int produced = instr.op == OpCode::ITOR2 || instr.op == OpCode::DUP ? 2 : 1;
+		const int consumed = instr.op == OpCode::PUSH ? 0 : OpCodeInfo::info(instr.op).nElements();
+		needed += consumed - produced;
+	}
+
+	DatumVector	stack;
+	for (size_t i = start; i < code->size(); ++i)
+		if (!foldInstr((*code)[i], stack)) {
+			unfoldable = code->size();
+			return false;
+		}
+
+	if (stack.size() != 1) {
+		unfoldable = code->size();
+		return false;
+	}
+
+	if (verbose)
+		cout << prefix(progName) << "folding " << start << ".." << code->size() - 1
+			 << " into " << stack.back() << '\n';
+
+	const unsigned line = indextbl[start];	// keep the expression's source line
+	retract(start);
+	emit(OpCode::PUSH, 0, stack.back());
+	indextbl.back() = line;
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * Discards any known value ranges, and the last short-circuit expression, of the retracted
+ * instructions as well.
+ *
+ * @param	pc		Address of the first instruction to discard
+ ************************************************************************************************/
+void PComp::retract(size_t pc) {
+	Compilier::retract(pc);
+	ranges.erase(ranges.lower_bound(pc), ranges.end());
+	if (pc < junction.end)
+		junction.begin = junction.end = 0;	// the short-circuit expression is gone
+	if (pc < unfoldable)
+		unfoldable = 0;
+	if (pc < target)
+		target = pc;
+}
+
+/********************************************************************************************//**
+ * Interval evaluation of code[pc..]; constants are known, as are the values loaded from
+ * variables recorded in ranges, and are propagated through negation, addition, subtraction,
+ * multiplication and limit checks. Anything else, or a result that might overflow, is unknown.
+ *
+ * @param	pc		Address of the first instruction of the expression
+ * @param	range	The value's range, if known
+ *
+ * @return	true if code[pc..] yields a single ordinal value of known range
+ ************************************************************************************************/
+bool PComp::rangeOf(size_t pc, Subrange& range) {
+	typedef pair<long long, long long>	Interval;
+	typedef pair<bool, Interval>		Value;			// Interval is valid if first is true
+
+	auto fits = [](const Interval& i) {
+		return i.first >= numeric_limits<int>::min() && i.second <= numeric_limits<int>::max();
+	};
+
+	vector<Value> stack;
+	for (size_t i = pc; i < code->size(); ++i) {
+		const Instr& instr = (*code)[i];
+		switch (instr.op) {
+		case OpCode::PUSH: {
+			const Datum& value = instr.value;
+			long long v = 0;
+			bool known = true;
+			switch (value.kind()) {
+			case Datum::Boolean:	v = value.boolean() ? 1 : 0;	break;
+			case Datum::Character:	v = value.character();			break;
+			case Datum::Integer:	v = value.integer();			break;
+			default:				known = false;
+			}
+			stack.push_back({ known, { v, v } });
+			break;
+		}
+
+		case OpCode::PUSHVAR:
+			stack.push_back({ false, { 0, 0 } });
+			break;
+
+		case OpCode::DUP:						// e.g., a reused address, below code[pc]
+			stack.push_back(stack.empty() ? Value { false, { 0, 0 } } : stack.back());
+			break;
+
+		case OpCode::EVAL: {
+			if (stack.empty() || instr.value != Datum(1))
+				return false;
+
+			auto it = ranges.find(i);
+			if (it != ranges.end())
+				stack.back() = { true, { it->second.min(), it->second.max() } };
+			else
+				stack.back() = { false, { 0, 0 } };
+			break;
+		}
+
+		case OpCode::NEG:
+			if (stack.empty())
+				return false;
+			stack.back().second = { -stack.back().second.second, -stack.back().second.first };
+			stack.back().first = stack.back().first && fits(stack.back().second);
+			break;
+
+		case OpCode::ADD:
+		case OpCode::SUB:
+		case OpCode::MUL: {
+			if (stack.size() < 2)
+				return false;
+
+			const Value rhs = stack.back();		stack.pop_back();
+			const Value lhs = stack.back();
+			const Interval& l = lhs.second;
+			const Interval& r = rhs.second;
+
+			Interval result { 0, 0 };
+			if (instr.op == OpCode::ADD)
+				result = { l.first + r.first, l.second + r.second };
+
+			else if (instr.op == OpCode::SUB)
+				result = { l.first - r.second, l.second - r.first };
+
+			else {
+				const long long p[] = {
+					l.first * r.first, l.first * r.second, l.second * r.first, l.second * r.second
+				};
+				result = { *min_element(begin(p), end(p)), *max_element(begin(p), end(p)) };
+			}
+
+			stack.back() = { lhs.first && rhs.first && fits(result), result };
+			break;
+		}
+
+		case OpCode::LLIMIT:					// TOS passed the check...
+			if (stack.empty())
+				return false;
+			stack.back().second.first = max<long long>(stack.back().second.first, instr.value.integer());
+			break;
+
+		case OpCode::ULIMIT:
+			if (stack.empty())
+				return false;
+			stack.back().second.second = min<long long>(stack.back().second.second, instr.value.integer());
+			break;
+
+		default:								// Give up on anything else
+			return false;
+		}
+	}
+
+	if (stack.size() != 1 || !stack.back().first || stack.back().second.first > stack.back().second.second)
+		return false;
+
+	range = Subrange(stack.back().second.first, stack.back().second.second);
+	return true;
+}
+
+/********************************************************************************************//**
+ * Emits a LLIMIT and/or a ULIMIT check of code[pc..]'s value, omitting either if rangeOf()
+ * proves that the check can't fail.
+ *
+ * @param	limits	The checked range
+ * @param	pc		Address of the first instruction of the checked expression
+ ************************************************************************************************/
+void PComp::emitLimits(const Subrange& limits, size_t pc) {
+	Subrange range;
+	const bool known = rangeOf(pc, range);
+
+	nLimits += 2;
+	if (known && range.min() >= limits.min())
+		++nLimitsRemoved;
+	else
+		emit(OpCode::LLIMIT, 0, limits.min());
+
+	if (known && range.max() <= limits.max())
+		++nLimitsRemoved;
+	else
+		emit(OpCode::ULIMIT, 0, limits.max());
+
+	if (verbose && known)
+		cout << prefix(progName) << "range of " << pc << ".." << code->size() - 1 << " is " << range
+			 << ", checking " << limits << '\n';
+}
+
+/********************************************************************************************//**
+ * Active for-loop iterators may not be modified by the loop body. Non-local variables
+ * written from a nested block are noted, as the range of their value is unknown at the point of
+ * any call that may write to them.
+ *
+ * @param	level	The current block level.
+ * @param	it		The variable written to
+ ************************************************************************************************/
+void PComp::written(int level, SymbolTableIter it) {
+	if (it->second.kind() != SymValue::Variable)
+		return;
+
+	if (iterators.find(&it->second) != iterators.end())
+		error("for-loop iterator may not be modified in the loop body", it->first);
+
+	if (level > it->second.level())
+		nonLocalWrites.insert(&it->second);
+}
+
+/********************************************************************************************//**
+ * Called following the left operand, code[pc..], of an and (or), emits a jump that skips the
+ * right operand if the left operand is false (true):
+ *
+ *     a and b:	a; jneqi F; b; jumpi E; F: push false; E:
+ *     a or b:	a; jneqi R; push true; jumpi E; R: b; E:
+ *
+ * If the left operand is itself an and (or), the chain is extended instead, so that each
+ * operand exits straight to the end. If the left operand is a constant, it's discarded, and the
+ * right operand is either the result, or is discarded by shortCircuitEnd().
+ *
+ * @param	pc		Address of the left operand
+ * @param	op		OpCode::AND or OpCode::OR
+ *
+ * @return	The state of the expression, to be passed to shortCircuitEnd()
+ ************************************************************************************************/
+PComp::ShortCircuit PComp::shortCircuit(size_t pc, OpCode op) {
+	ShortCircuit sc { op, pc, 0, {}, false, false };
+
+	if (code->size() == pc + 1 && code->back().op == OpCode::PUSH
+			&& code->back().value.kind() == Datum::Boolean) {
+		sc.known = true;
+		sc.value = code->back().value.boolean();
+		retract(pc);
+		return sc;
+	}
+
+	if (junction.op == op && junction.begin == pc && junction.end == code->size()) {
+		sc.exits = junction.exits;			// extend the chain...
+		if (op == OpCode::AND)
+			retract(code->size() - 2);		// reopen; discard "jumpi E; push false"
+	}
+
+	if (op == OpCode::AND)
+		sc.exits.push_back(emitJNEQI());
+
+	else {
+		const size_t jmp_pc = emitJNEQI();
+		sc.exits.push_back(emit(OpCode::PUSH, 0, true));
+		emitJumpI();
+		(*code)[jmp_pc].value = code->size();
+	}
+
+	return sc;
+}
+
+/********************************************************************************************//**
+ * Called following the right operand of the and/or whose state is sc; emits the and's false
+ * result, and patches the early exits to the end of the expression.
+ *
+ * @param	sc		The state returned by shortCircuit()
+ ************************************************************************************************/
+void PComp::shortCircuitEnd(const ShortCircuit& sc) {
+	if (sc.known) {							// false and b, or true or b; b isn't evaluated
+		if (sc.value == (sc.op == OpCode::OR)) {
+			retract(sc.begin);
+			emit(OpCode::PUSH, 0, sc.value);
+		}
+		return;								// otherwise, the result is b
+	}
+
+	if (sc.op == OpCode::AND) {
+		const size_t jmp_pc = emitJumpI();
+		patch(sc.exits, emit(OpCode::PUSH, 0, false));
+		patch({ jmp_pc }, code->size());
+
+	} else
+		for (auto pc : sc.exits)			// the jumpi following each push true
+			patch({ pc + 1 }, code->size());
+
+	junction = sc;
+	junction.end = code->size();
+}
+
+/********************************************************************************************//**
+ * @param	pcs		Addresses of the jump instructions
+ * @param	where	The jump to address
+ ************************************************************************************************/
+void PComp::patch(const vector<size_t>& pcs, size_t where) {
+	if (!pcs.empty())
+		target = max(target, where);
+
+	for (auto pc : pcs) {
+		if (verbose)
+			cout << prefix(progName) << "patching address at " << pc << " to " << where << '\n';
+		(*code)[pc].value = where;
 	}
 }
 
@@ -173,7 +949,7 @@ void PComp::assignPromote (TDescPtr lhs, TDescPtr rhs) {
  *
  * @return	Data type 
  ************************************************************************************************/
-TDescPtr PComp::identFactor(int level, const string& id, bool var) {
+TDescPtr PComp::identFactor(int level, Atom id, bool var) {
 	auto type = TypeDesc::newIntDesc();
    	auto it = lookup(id);
 
@@ -192,17 +968,37 @@ TDescPtr PComp::identFactor(int level, const string& id, bool var) {
 			assert(!type->ref());
 			break;
 
-		case SymValue::Variable:
+		case SymValue::Variable: {
+			const size_t pc = code->size();
 			type = variable(level, it);
+			if (!var)
+				reuseLvalue(pc);
 			assert(type != nullptr);
 			assert(type->base() != nullptr);
 			type = type->base();
 			assert(type != nullptr);
-			if (!var)
-				emit(OpCode::EVAL, 0, type->size());
+			if (var)
+				written(level, it);
+
+			else {
+				const size_t eval_pc = emit(OpCode::EVAL, 0, type->size());
+
+				// A scalar variable's value is within the loop range if it's an active for-loop
+				// iterator, or within its declared range once it's known to have been assigned by
+				// this block. Constant indexes, and field offsets, are folded into the variable
+				// reference, so the variable itself must be the scalar...
+				if (code->size() - pc == 2 && isScalar(it->second.type())) {
+					auto i = iterators.find(&it->second);
+					if (i != iterators.end())
+						ranges[eval_pc] = i->second;
+					else if (it->second.level() == level && assigned.find(&it->second) != assigned.end())
+						ranges[eval_pc] = type->range();
+				}
+			}
 			if (type->ref())
 				emit(OpCode::EVAL, 0, type->size());
 			break;
+		}
 
 		case SymValue::Function:
 			type = it->second.type();		// Use the function return type
@@ -227,6 +1023,7 @@ TDescPtr PComp::identFactor(int level, const string& id, bool var) {
  ************************************************************************************************/
 TDescPtr PComp::builtInFunc(int level)
 {
+	const size_t pc = code->size();		// fold from here, if possible
 	auto type = TypeDesc::newIntDesc();	// Factor data type
 	ostringstream oss;
 
@@ -336,11 +1133,9 @@ TDescPtr PComp::builtInFunc(int level)
 		type = expression(level);
 		expect(Token::CloseParen);	
 
-		if (type->tclass() == TypeDesc::Integer)
-			type = TypeDesc::newRealDesc();		// Always produces a real
-		else if (type->tclass() != TypeDesc::Real)
+		if (type->tclass() != TypeDesc::Integer && type->tclass() != TypeDesc::Real)
 			oss << "expeced integer, or real value, got: " << current();
-		emit(OpCode::SQR);
+		emit(OpCode::SQR);						// Produces the same type
 
 	} else if (accept(Token::Sqrt)) {	// Replace TOS with sqrt(TOS)
 		expect(Token::OpenParen);
@@ -370,15 +1165,19 @@ TDescPtr PComp::builtInFunc(int level)
 		if (!type->ordinal()) {
 			oss << "expected ordinal, got: " << current();
 			error(oss.str());
-		} else 
+		} else {						// Convert a character or boolean to it's integer value
+			if (type->tclass() == TypeDesc::Boolean || type->tclass() == TypeDesc::Character)
+				emit(OpCode::ORD);
 			type = TypeDesc::newIntDesc();
+		}
 
 	} else {
 		oss << "bultInFunc: syntax error; expected ident | num | { expr }, got: " << current();
 		error(oss.str());
 		next();
 	}
-		
+
+	fold(pc);
 	return type;
 }
 
@@ -397,7 +1196,7 @@ TDescPtr PComp::factor(int level, bool var) {
 
 	auto type = TypeDesc::newIntDesc();			// Factor data type
 	if (accept(Token::Identifier, false)) {		// Copy, and then consume the identifer...
-    	const string id = ts.current().string_value;
+    	const Atom id = ts.current().atom;
     	next();
 		type = identFactor(level, id, var);
 
@@ -419,8 +1218,10 @@ TDescPtr PComp::factor(int level, bool var) {
 		expect(Token::CloseParen);
 
 	} else if (accept(Token::Not)) {
-		emit(OpCode::NOT);
+		const size_t pc = code->size();
 		type = factor(level, var);
+		emit(OpCode::NOT);
+		fold(pc);
 
 	} else if (accept(Token::Character, false)) {
 		const string s = ts.current().string_value;
@@ -469,27 +1270,33 @@ TDescPtr PComp::term(int level, bool var) {
 	if (verbose)
 		cout << prefix(progName) << "terminal(" << level << ',' << boolalpha << var << ")\n";
 
+	const size_t pc = code->size();			// fold from here, if possible
 	auto lhs = factor(level, var);
 	for (;;) {
 		if (accept(Token::Multiply)) {
 			lhs = promote(lhs, factor(level, var));
 			emit(OpCode::MUL);
+			fold(pc);
 			
 		} else if (accept(Token::Divide)) {
 			lhs = promote(lhs, factor(level, var));
-			emit(OpCode::DIV);	
+			emit(OpCode::DIV);
+			fold(pc);	
 			
 		} else if (accept(Token::Mod)) {
 			lhs = promote(lhs, factor(level, var));
 			emit(OpCode::REM);
+			fold(pc);
 
 		} else if (accept(Token::BitAnd)) {
 			lhs = promote(lhs, factor(level, var));
 			emit(OpCode::BAND);
+			fold(pc);
 			
 		} else if (accept(Token::And)) {
+			const ShortCircuit sc = shortCircuit(pc, OpCode::AND);
 			lhs = promote(lhs, factor(level, var));
-			emit(OpCode::AND);
+			shortCircuitEnd(sc);
 
 		} else
 			break;
@@ -511,6 +1318,7 @@ TDescPtr PComp::unary(int level, bool var) {
 	if (verbose)
 		cout << prefix(progName) << "unary(" << level << ',' << boolalpha << var << ")\n";
 
+	const size_t pc = code->size();			// fold from here, if possible
 	auto type = TypeDesc::newIntDesc();		// Default factor data type
 	if (accept(Token::Add)) 
 		type = term(level, var);			// ignore unary + 
@@ -518,10 +1326,12 @@ TDescPtr PComp::unary(int level, bool var) {
 	else if (accept(Token::Subtract)) {
 		type = term(level, var);
 		emit(OpCode::NEG);
+		fold(pc);
 
 	} else if (accept(Token::BitNot)) {
 		type = term(level, var);
 		emit(OpCode::BNOT);
+		fold(pc);
 
 	} else									
 		type = term(level, var);
@@ -542,35 +1352,43 @@ TDescPtr PComp::simpleExpr(int level, bool var) {
 	if (verbose)
 		cout << prefix(progName) << "simple-expr(" << level << ',' << boolalpha << var << ")\n";
 
+	const size_t pc = code->size();			// fold from here, if possible
 	auto lhs = unary(level, var);
 	for (;;) {
 		if (accept(Token::Add)) {
 			lhs = promote(lhs, unary(level, var));
 			emit(OpCode::ADD);
+			fold(pc);
 
 		} else if (accept(Token::Subtract)) {
 			lhs = promote(lhs, unary(level, var));
 			emit(OpCode::SUB);
+			fold(pc);
 
 		} else if (accept(Token::BitOr)) {
 			lhs = promote(lhs, unary(level, var));
 			emit(OpCode::BOR);
+			fold(pc);
 
 		} else if (accept(Token::BitXor)) {
 			lhs = promote(lhs, unary(level, var));
 			emit(OpCode::BXOR);
+			fold(pc);
 
 		} else if (accept(Token::ShiftLeft)) {
 			lhs = promote(lhs, unary(level, var));
 			emit(OpCode::SHIFTL);
+			fold(pc);
 
 		} else if (accept(Token::ShiftRight)) {
 			lhs = promote(lhs, unary(level, var));
 			emit(OpCode::SHIFTR);
+			fold(pc);
 
 		} else if (accept(Token::Or)) {
+			const ShortCircuit sc = shortCircuit(pc, OpCode::OR);
 			lhs = promote(lhs, unary(level, var));
-			emit(OpCode::OR);
+			shortCircuitEnd(sc);
 
 		} else
 			break;
@@ -592,31 +1410,44 @@ TDescPtr PComp::expression(int level, bool var) {
 	if (verbose)
 		cout << prefix(progName) << "expresson(" << level << ',' << boolalpha << var << ")\n";
 
+	const size_t pc = code->size();			// fold from here, if possible
 	auto lhs = simpleExpr(level, var);
 	for (;;) {
 		if (accept(Token::LTE)) {
-			lhs = promote(lhs, simpleExpr(level, var));
+			promote(lhs, simpleExpr(level, var));
 			emit(OpCode::LTE);
+			fold(pc);
+			lhs = TypeDesc::newBoolDesc();
 
 		} else if (accept(Token::LT)) {
-			lhs = promote(lhs, simpleExpr(level, var));
+			promote(lhs, simpleExpr(level, var));
 			emit(OpCode::LT);
+			fold(pc);
+			lhs = TypeDesc::newBoolDesc();
 
 		} else if (accept(Token::GT)) {
-			lhs = promote(lhs, simpleExpr(level, var));
+			promote(lhs, simpleExpr(level, var));
 			emit(OpCode::GT);
+			fold(pc);
+			lhs = TypeDesc::newBoolDesc();
 			
 		} else if (accept(Token::GTE)) {
-			lhs = promote(lhs, simpleExpr(level, var));
+			promote(lhs, simpleExpr(level, var));
 			emit(OpCode::GTE);
+			fold(pc);
+			lhs = TypeDesc::newBoolDesc();
 			
 		} else if (accept(Token::EQU)) {
-			lhs = promote(lhs, simpleExpr(level, var));
+			promote(lhs, simpleExpr(level, var));
 			emit(OpCode::EQU);
+			fold(pc);
+			lhs = TypeDesc::newBoolDesc();
 
 		} else if (accept(Token::NEQ)) {
-			lhs = promote(lhs, simpleExpr(level, var));
+			promote(lhs, simpleExpr(level, var));
 			emit(OpCode::NEQ);
+			fold(pc);
+			lhs = TypeDesc::newBoolDesc();
 
 		} else
 			break;
@@ -625,6 +1456,40 @@ TDescPtr PComp::expression(int level, bool var) {
 	return lhs;
 }
 
+/********************************************************************************************//**
+ * expression
+ *
+ * Emits the expression followed by a JNEQI. If the expression is a short-circuit and/or, it's
+ * lowered to jumps instead of a Boolean value; each operand of an and jumps directly to the
+ * false target, and each operand of an or, but the last, jumps directly past the condition.
+ *
+ * @param	level	The current block level
+ * @return	Addresses of the jumps to be patched with the false target
+ ************************************************************************************************/
+vector<size_t> PComp::condition(int level) {
+	const size_t pc = code->size();
+	expression(level);
+
+	vector<size_t> exits;
+	if (junction.begin == pc && junction.end == code->size() && junction.end > pc) {
+		const ShortCircuit sc = junction;
+		if (sc.op == OpCode::AND) {
+			retract(code->size() - 2);		// discard "jumpi E; push false"
+			exits = sc.exits;
+			exits.push_back(emitJNEQI());
+
+		} else {
+			exits.push_back(emitJNEQI());
+			for (auto push_pc : sc.exits)	// replace each "push true" with a jump past the test
+				(*code)[push_pc] = Instr(OpCode::JUMPI, 0, Datum(code->size()));
+		}
+
+	} else
+		exits.push_back(emitJNEQI());
+
+	return exits;
+}
+
 /********************************************************************************************//**
  * expr-lst: expression { ',' expression } ;
  *
@@ -698,7 +1563,7 @@ PComp::ConstExprValue PComp::constFactor() {
 		next();										// Consume the number
 
 	} else if (accept(Token::Identifier, false)) {	// Copy, and then, consume the identifier..
-		auto it = lookup(ts.current().string_value);
+		auto it = lookup(ts.current().atom);
 		next(); 									// consume the identifier
 
 		switch (it->second.kind()) {
@@ -938,18 +1803,48 @@ PComp::ConstExprValue PComp::constExpr() {
  * @param	it		The sub-routines symbol table entry
  ************************************************************************************************/
 void PComp::callStatement(int level, SymbolTableIter it) {
-	if (expect(Token::OpenParen)) {
-		unsigned nParams = 0;					// Count actual parameters
+	const auto& params = it->second.params(); // Formal parameter kinds
+	const int8_t depth = level - it->second.level();
+
+	const size_t site = sites.size();			// Note the call site, for profiles
+	sites.push_back(numeric_limits<size_t>::max());
+
+	// Inline the callee? It's parameters, return value and locals are then slots in our frame
+	const auto body = bodies.find(&it->second);
+	const bool inlined = body != bodies.end() && !frames.empty()
+					  && body->second.end - body->second.begin <= siteLimit(site);
+	const int slots = inlined ? frames.back().next : 0;
+	if (inlined) {
+		frames.back().next += params.size() + FrameSize + body->second.locals;
+		frames.back().high = max(frames.back().high, frames.back().next);
+	}
 
-		const auto& params = it->second.params(); // Formal parameter kinds
+	unsigned nParams = 0;						// Count actual parameters
+	if (expect(Token::OpenParen)) {
 		if (!accept(Token::CloseParen, false))
 			do {								// collect actual parameters
-				if (params.size() > nParams) {
+				if (inlined && params.size() > nParams)
+					emit(OpCode::PUSHVAR, 0, slots + nParams);
+
+				if (params.size() > nParams && params[nParams]->ref()) {
+					// The variable must have the same type, including it's range, as the
+					// parameter, as either may assign values to the other
+					const auto param = params[nParams];
+					const auto kind = expression(level, true);
+					if (kind->tclass() != param->tclass())
+						error("incompatable var parameter type");
+					else if (param->ordinal() && kind->range() != param->range())
+						error("var parameter range differs from the variables range");
+
+				} else if (params.size() > nParams) {
+					const size_t pc = code->size();
 					const auto kind = expression(level, params[nParams]->ref());
-					assignPromote(params[nParams], kind);
+					assignPromote(params[nParams], kind, pc);
 				} else
 					expression(level); 			// consume the expression...
 
+				if (inlined && params.size() > nParams)
+					emit(OpCode::ASSIGN, 0, 1);
 				++nParams;
 
 			} while (accept (Token::Comma));
@@ -966,7 +1861,30 @@ void PComp::callStatement(int level, SymbolTableIter it) {
 	if (SymValue::Procedure != it->second.kind() && SymValue::Function != it->second.kind())
 		error("Identifier is not a function or procedure", it->first);
 
-	emitCallI(level - it->second.level(), it->second.value().natural());
+	if (inlined) {
+		if (verbose)
+			cout << prefix(progName) << "inlining " << it->first << " at " << code->size() << "\n";
+
+		inlineBody(depth, body->second, slots, params.size(), SymValue::Function == it->second.kind());
+		frames.back().next = slots;				// Our slots are free once we're done
+		lastCall.tail = false;
+		return;
+	}
+
+	bool refs = false;						// Any var, or multi-Datum, parameters?
+	for (const auto& param : params)
+		refs = refs || param->ref() || param->size() != 1;
+
+	const size_t pc = emitCallI(depth, it->second.value().natural());
+	sites[site] = pc;
+	if (0 == it->second.value().natural())	// Calling an enclosing subroutine; patch it later
+		unresolved[&it->second].push_back(pc);
+
+	lastCall = Call {	pc,
+						it->second.kind(),
+						it->second.type(),
+						params.size(),
+						depth > 0 && !refs && params.size() <= numeric_limits<int8_t>::max()	};
 }
 
 /********************************************************************************************//**
@@ -990,33 +1908,101 @@ void PComp::statementList(int level, SymbolTableEntry& context) {
 	} while (accept(Token::SemiColon));
 }
 
+/********************************************************************************************//**
+ * The variable's offset may not become more negative than it was, so the reference itself can't
+ * fall below the bottom of the stack; e.g., a[i], where a is array [100..110], keeps it's lower
+ * bound subtraction if a is too close to the bottom of it's frame.
+ *
+ * @param	base	Address of a variable reference, PUSHVAR level, offset, or noBase
+ * @param	offset	The constant to add to the reference
+ * @return	true if offset was folded into the reference
+ ************************************************************************************************/
+bool PComp::rebase(size_t base, long long offset) {
+	if (base == noBase || (*code)[base].op != OpCode::PUSHVAR)
+		return false;
+
+	const long long from = (*code)[base].value.integer();
+	const long long to = from + offset;
+	if (to > numeric_limits<int>::max() || to < numeric_limits<int>::min() || (to < 0 && to < from))
+		return false;
+
+	if (verbose)
+		cout << prefix(progName) << "rebasing " << base << " from " << from << " to " << to << '\n';
+	(*code)[base].value = static_cast<int>(to);
+	return true;
+}
+
+/********************************************************************************************//**
+ * An assignment's right-hand-side that starts with the left-hand-side's variable, e.g.,
+ * a[i].x := a[i].x + 1, finds it's address on the top of the stack, so the copy, including it's
+ * limit checks, is replaced by a DUP, as long as the address has no side effects, i.e., makes no
+ * calls. A lone PUSHVAR is left as is; it's no more expensive than the DUP, and the JIT, and
+ * register translator, fuse it with the following EVAL.
+ *
+ * @param	pc	Address of a variable reference just emitted
+ ************************************************************************************************/
+void PComp::reuseLvalue(size_t pc) {
+	const size_t n = lvalue.end - lvalue.begin;
+	if (pc != lvalue.end || n < 2 || code->size() - pc != n)
+		return;
+
+	for (size_t i = 0; i < n; ++i) {
+		const Instr& l = (*code)[lvalue.begin + i];
+		const Instr& r = (*code)[pc + i];
+		if (l.op != r.op || l.level != r.level || !(l.value == r.value) || l.value.kind() != r.value.kind())
+			return;
+
+		switch (l.op) {
+		case OpCode::PUSH:
+		case OpCode::PUSHVAR:
+		case OpCode::EVAL:
+		case OpCode::ADD:
+		case OpCode::SUB:
+		case OpCode::MUL:
+		case OpCode::LLIMIT:
+		case OpCode::ULIMIT:
+			break;
+
+		default:
+			return;
+		}
+	}
+
+	if (verbose)
+		cout << prefix(progName) << "reusing the address at " << lvalue.begin << " at " << pc << '\n';
+	retract(pc);
+	emit(OpCode::DUP);
+}
+
 /********************************************************************************************//**
  * Array index expression-lst.
  *
  * Process a possibly multi-dimensional,  array index. The opening bracket has already been
- * consumed, and the caller will consume consume the closing bracket.
+ * consumed, and the caller will consume consume the closing bracket. Each index is checked,
+ * scaled and added to the array reference in turn; constant indexes are folded into a single
+ * offset, without limit checks. The lower bound, and constant indexes, are folded into the
+ * variable reference at base, if any, so only the variable part of the index is computed at run
+ * time, e.g., on each iteration of a loop.
  *
  * @param	level	The current block level.
  * @param	it		The arrays's entry into the symbol table
  * @param	type	The array's type
+ * @param	base	Address of the array's variable reference, or none
  *
  * @return	The arrays base type
  ************************************************************************************************/
-TDescPtr PComp::varArray(int level, SymbolTableIter it, TDescPtr type) {
+TDescPtr PComp::varArray(int level, SymbolTableIter it, TDescPtr type, size_t base) {
 	TDescPtr atype = type;					// The arrays type, e.g, ArrayDesc
 	type = atype->base();					// We'll return the arrays base type...
 
 	if (atype->tclass() != TypeDesc::Array)
 		error("attempt to index into non-array", it->first);
 
-	auto indexes = expressionList(level);	// expr {, expr }...
-	if (indexes.empty())
-		error("expected expression-list");
+	for (;;) {								// process each index, in turn
+		const size_t pc = code->size();		// start of the index expression
+		auto index = expression(level);
 
-	unsigned nindexes = indexes.size();
-	for (auto index : indexes) {			// process each index, in turn
-		emit(OpCode::LLIMIT, 0, atype->range().min());
-		emit(OpCode::ULIMIT, 0, atype->range().max());
+		emitLimits(atype->range(), pc);
 
 		if (atype->itype()->tclass() != index->tclass()) {
 			ostringstream oss;
@@ -1030,16 +2016,30 @@ TDescPtr PComp::varArray(int level, SymbolTableIter it, TDescPtr type) {
 		}
 
 		// offset index for non-zero based arrays
-		if (atype->range().min() != 0) {
-			emit(OpCode::PUSH, 0, atype->range().min());
+		const long long lower = static_cast<long long>(atype->range().min()) * type->size();
+		if (lower != 0 && !rebase(base, -lower)) {
+			emit(OpCode::PUSH, 0, atype->range().min() * static_cast<int>(type->size()));
 			emit(OpCode::SUB);
 		}
 
-		emit(OpCode::ADD);					// index into the array
-				
-		if (--nindexes) {					// link to next (base) if there's another index
-			atype = type;					// The arrays type
-			type = atype->base();			// We'll return the arrays base type...
+		// index into the array, unless the offset is a constant zero, or folded into base
+		fold(pc);
+		if (code->size() - pc == 1 && code->back().op == OpCode::PUSH
+				&& code->back().value.kind() == Datum::Integer
+				&& (code->back().value.integer() == 0 || rebase(base, code->back().value.integer())))
+			retract(pc);
+		else
+			emit(OpCode::ADD);
+
+		if (!accept(Token::Comma))
+			break;
+
+		atype = type;						// link to next (base) for the next index
+		type = atype->base();
+
+		if (atype->tclass() != TypeDesc::Array) {
+			error("attempt to index into non-array", it->first);
+			break;
 		}
 	}
 
@@ -1051,14 +2051,15 @@ TDescPtr PComp::varArray(int level, SymbolTableIter it, TDescPtr type) {
  *
  * @param	it		Variable's entry into the symbol table
  * @param 	type	The owning record type
+ * @param	base	Address of the record's variable reference, or none
  * @return	The identifier type
  ************************************************************************************************/
-TDescPtr PComp::varSelector(SymbolTableIter it, TDescPtr type) {
+TDescPtr PComp::varSelector(SymbolTableIter it, TDescPtr type, size_t base) {
 	if (type->tclass() != TypeDesc::Record)
 		error("attempted selector reference into non-record", it->first);
 
 	// Copy, and then consume, the selector identifier...
-	const string selector = ts.current().string_value;
+	const Atom selector = ts.current().atom;
 	if (expect(Token::Identifier)) {
 		size_t offset = 0;					// Calc the offset into the record...
 		for (const auto& fld : type->fields()) {
@@ -1069,7 +2070,7 @@ TDescPtr PComp::varSelector(SymbolTableIter it, TDescPtr type) {
 			offset += fld.type()->size();
 		}
 
-		if (offset > 0) {				// Don't bother if it's the 1st field...
+		if (offset > 0 && !rebase(base, offset)) {	// Don't bother if it's the 1st field...
 			emit(OpCode::PUSH, 0, offset);
 			emit(OpCode::ADD);
 		}
@@ -1140,22 +2141,26 @@ TDescPtr PComp::attribute(SymbolTableIter it, TDescPtr type) {
  ************************************************************************************************/
 TDescPtr PComp::variable(int level, SymbolTableIter it) {
 	TDescPtr type = emitVarRef(level, it->second);
-	if (it->second.type()->ref())			// dereference if necessary...
+	size_t base = code->size() - 1;			// Constant offsets may be folded into the reference...
+	if (it->second.type()->ref()) {			// dereference if necessary...
 		emit(OpCode::EVAL, 0, type->size());
+		base = noBase;						// ...until it's dereferenced
+	}
 
 	// process composite-desc's, if any...
 	for (;;) {
 		if (accept(Token::OpenBrkt)) {		// variable is an array, index into it
-			type = TypeDesc::newPointerDesc(varArray(level, it, type->base()));
+			type = TypeDesc::newPointerDesc(varArray(level, it, type->base(), base));
 			expect(Token::CloseBrkt);
 
 		} else if (accept(Token::Period))	// handle record selector...
-			type = TypeDesc::newPointerDesc(varSelector(it, type->base()));
+			type = TypeDesc::newPointerDesc(varSelector(it, type->base(), base));
 
 		else if (accept(Token::Caret)) {	// 'Dereference' pointer (use pointed to type)
 			emit(OpCode::EVAL, 0, type->base()->size());	
 			assert(type->base() != nullptr);
 			type = type->base();
+			base = noBase;
 
 		} else
 			break;							// no more composite-desc(s)
@@ -1192,7 +2197,69 @@ TDescPtr PComp::lvalueRef(int level, SymbolTableIter it, bool dup) {
 }
 
 /********************************************************************************************//**
- * variable := expression 
+ * variable ( += | -= | *= | /= ) expression
+ *
+ * The variable's address, already emitted, is evaluated once. An integer, or real, variable is
+ * updated in place, by ADDTO, SUBTO, MULTO or DIVTO; one whose range is limited is loaded, via a
+ * DUP of it's address, so that the result may be limit checked before it's assigned.
+ *
+ * @param	level	The current block level.
+ * @param	type	Reference to the variable
+ * @param	known	Is the variable known to have been assigned?
+ *
+ * @return	false if the current token isn't a compound assignment operator
+ ************************************************************************************************/
+bool PComp::compoundAssign(int level, TDescPtr type, bool known) {
+	OpCode op, update;
+	switch (ts.current().kind) {
+	case Token::AddAssign:		op = OpCode::ADD;	update = OpCode::ADDTO;	break;
+	case Token::SubtractAssign:	op = OpCode::SUB;	update = OpCode::SUBTO;	break;
+	case Token::MultiplyAssign:	op = OpCode::MUL;	update = OpCode::MULTO;	break;
+	case Token::DivideAssign:	op = OpCode::DIV;	update = OpCode::DIVTO;	break;
+	default:
+		return false;
+	}
+	next();
+
+	const TDescPtr lhs = type->base();
+	if (!isAnInteger(lhs) && !isAReal(lhs))
+		error("expected an integer or real variable");
+
+	const bool limited = lhs->ordinal() && lhs->range() != TypeDesc::maxRange;
+	const size_t dup_pc = code->size();
+	if (limited) {
+		emit(OpCode::DUP);
+		const size_t eval_pc = emit(OpCode::EVAL, 0, 1);
+		if (known)							// The value was checked when it was assigned
+			ranges[eval_pc] = lhs->range();
+	}
+
+	const size_t pc = code->size();
+	auto rhs = expression(level);
+	if (isAnInteger(lhs) && isAReal(rhs)) {
+		error("rounding real to fit in an integer");
+		emit(OpCode::ROUND);
+
+	} else if (isAReal(lhs) && isAnInteger(rhs))
+		emit(OpCode::ITOR);
+
+	else if (!isAnInteger(rhs) && !isAReal(rhs))
+		error("incompatable assignment types");
+	fold(pc);
+
+	if (limited) {
+		emit(op);
+		emitLimits(lhs->range(), dup_pc);
+		emit(OpCode::ASSIGN, 0, 1);
+
+	} else
+		emit(update);
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * variable := expression | variable ( += | -= | *= | /= ) expression
  *
  * @param	level	The current block level.
  * @param	it		The variable, or function, identifier
@@ -1201,16 +2268,38 @@ TDescPtr PComp::lvalueRef(int level, SymbolTableIter it, bool dup) {
  * @return	Reference to the variable reference
  ************************************************************************************************/
 void PComp::assignStatement(int level, SymbolTableIter it, bool dup) {
+	const size_t lpc = code->size();
 	TDescPtr type = lvalueRef(level, it, dup);
+	written(level, it);
+
+	// Assigning a local scalar variable, other than in a conditional, or repeated, statement,
+	// assures that it's been assigned for the remainder of the block. Assigning an element, or
+	// field, doesn't, even if it's reference is folded into a single pushvar...
+	const bool whole =	it->second.kind() == SymValue::Variable
+					&&	it->second.level() == level
+					&&	isScalar(it->second.type())
+					&&	!dup
+					&&	code->size() - lpc == 1;
+	const bool known = whole && assigned.find(&it->second) != assigned.end();
+	if (compoundAssign(level, type, known)) {
+		if (whole && branches == 0)
+			assigned.insert(&it->second);
+		return;
+	}
 	expect(Token::Assign);
 
 	// Emit the r-value and assignment...
 
+	const size_t pc = code->size();
+	lvalue = Lvalue { lpc, pc };
 	auto rtype = expression(level);
-	assignPromote(type->base(), rtype);
+	lvalue = Lvalue { 0, 0 };
+	assignPromote(type->base(), rtype, pc);
 	emit(OpCode::ASSIGN, 0, type->base()->size());
 	if (it->second.kind() == SymValue::Function)
 		it->second.returned(true);
+	else if (whole && branches == 0)
+		assigned.insert(&it->second);
 }
 
 /********************************************************************************************//**
@@ -1224,7 +2313,7 @@ void PComp::assignStatement(int level, SymbolTableIter it, bool dup) {
  ************************************************************************************************/
 bool PComp::identStatement(int level) {
 	if (accept(Token::Identifier, false)) {
-		auto lhs = lookup(ts.current().string_value);
+		auto lhs = lookup(ts.current().atom);
 		next();
 
 		if (lhs != symtbl.end()) {			// unidentified identifier?
@@ -1261,20 +2350,17 @@ bool PComp::ifStatement(int level, SymbolTableEntry& context) {
 	if (accept(Token::If)) {				// if expr then stmt { then stmt... }
 		vector<size_t> jmp_end;					// Jump to the end locations..
 
-		expression(level);						// Condition expression
-		size_t jmp_pc = emitJNEQI();			// Jump if condition is false
+		vector<size_t> jmp_false = condition(level); // Jump if condition is false
 		expect(Token::Then);					// Consume "then"
+		++branches;
 		statementList(level, context);			// Statements...
 
 		while (accept(Token::Elif)) {			// 0 or more elif...
 			jmp_end.push_back(emitJumpI());		// Jump to the end...
 
-			if (verbose)						// jump here if above condition was false
-				cout << prefix(progName) << "patching address at " << jmp_pc << " to " << code->size() << '\n';
-			(*code)[jmp_pc].value = code->size();
+			patch(jmp_false, code->size());		// jump here if above condition was false
 
-			expression(level);					// Condition expression
-			jmp_pc = emitJNEQI();				// Jump if condition is false
+			jmp_false = condition(level);		// Jump if condition is false
 			expect(Token::Then);				// Consume "then"
 			statementList(level, context);		// Statements...
 		}
@@ -1282,25 +2368,15 @@ bool PComp::ifStatement(int level, SymbolTableEntry& context) {
 		if (accept(Token::Else)) {
 			jmp_end.push_back(emitJumpI());		// Jump to the end...
 
-			if (verbose)						// Jump here if above condition was false
-				cout << prefix(progName) << "patching address at " << jmp_pc << " to " << code->size() << '\n';
-			(*code)[jmp_pc].value = code->size();
-			jmp_pc = 0;
+			patch(jmp_false, code->size());		// Jump here if above condition was false
+			jmp_false.clear();
 
 			statementList(level, context);		// Statements...
 		}
+		--branches;
 
-		if (jmp_pc) {
-			if (verbose)							// Final jump over to here...
-				cout << prefix(progName) << "patching address at " << jmp_pc << " to " << code->size() << '\n';
-			(*code)[jmp_pc].value = code->size();
-		}
-
-		for (size_t pc : jmp_end) {				// Patch jumps to here
-			if (verbose)
-				cout << prefix(progName) << "patching address at " << pc << " to " << code->size() << '\n';
-			(*code)[pc].value = code->size();
-		}
+		patch(jmp_false, code->size());			// Final jump over to here...
+		patch(jmp_end, code->size());			// Patch jumps to here
 
 		expect(Token::Endif);
 
@@ -1319,19 +2395,15 @@ bool PComp::ifStatement(int level, SymbolTableEntry& context) {
 bool PComp::whileStatement(int level, SymbolTableEntry& context) {
 	if (accept(Token::While)) {
 		const auto cond_pc = code->size();	// Start of while expr
-		expression(level);
-
-		// jump if expr is false...
-		const auto jmp_pc = emitJNEQI();
+		const auto jmp_false = condition(level); // jump if expr is false...
 		expect(Token::Loop);				// consume "loop"
+		++branches;
 		statementList(level, context);
+		--branches;
 		expect(Token::Endloop);
 
 		emitJumpI(cond_pc);					// Jump back to expr test...
-
-		if (verbose)
-			cout << prefix(progName) << "patching address at " << jmp_pc << " to " << code->size() << '\n';
-		(*code)[jmp_pc].value = code->size(); 
+		patch(jmp_false, code->size());
 
 		return true;
 	}
@@ -1348,10 +2420,11 @@ bool PComp::whileStatement(int level, SymbolTableEntry& context) {
 bool PComp::repeatStatement(int level, SymbolTableEntry& context) {
 	if (accept(Token::Repeat)) {
 		const size_t loop_pc = code->size();			// jump here until expr fails
+		++branches;
 		statementList(level, context);
+		--branches;
 		expect(Token::Until);
-		expression(level);
-		emitJNEQI(loop_pc);
+		patch(condition(level), loop_pc);
 		expect(Token::Endloop);
 
 		return true;
@@ -1361,19 +2434,29 @@ bool PComp::repeatStatement(int level, SymbolTableEntry& context) {
 }
 
 /********************************************************************************************//**
- * for identifier := expresson ( to | downto ) condition do statement
+ * for identifier in [ reverse ] ordinal-type loop statement-list endloop
+ *
+ * The iterator's address, and it's last value, are kept on the stack for the duration of the
+ * loop. FORINIT assigns the first value, and FORNEXT, at the bottom of the loop, steps the
+ * iterator and jumps back to the loop body until the last value is reached, so that the iterator
+ * never steps past the end of the range. The range is a type, so it's never empty, and is know
+ * at compile time. If the range exceeds the range of the iterator, the loop stops at the
+ * iterator's limit, followed by a check that fails, as the next step would have. Within the
+ * loop body, the iterator is known to be within the range, provided it's a local variable that
+ * isn't written by a nested block, nor a program level variable of a lazy compilation; the body
+ * may not modify the iterator.
  *
  * @param	level	The current block level.
  * @param	context	The enclosing subroutine context
  ************************************************************************************************/
 bool PComp::forStatement(int level, SymbolTableEntry& context) {
 	if (accept(Token::For)) {
-		auto var = lookup(ts.current().string_value);
+		auto var = lookup(ts.current().atom);
 		expect(Token::Identifier);			// consume the identifier...
 		if (var == symtbl.end())
 			return true;					// give up if the identifier is undefined
 		auto lhs = lvalueRef(level, var, false);
-		emit(OpCode::DUP);					// dupliate the iternator reference
+		written(level, var);
 
 		expect(Token::In);					// "for" identifier "in" ...
 
@@ -1394,47 +2477,50 @@ bool PComp::forStatement(int level, SymbolTableEntry& context) {
 			return true;					// give up...
 		}
 
-		if (inc == 1)
-			emit(OpCode::PUSH, 0, range->range().min());
-		else
-			emit(OpCode::PUSH, 0, range->range().max());
-			
-		emit(OpCode::ASSIGN, 0, lhs->size()); // initialize the iterator
-
-		const auto cond_pc = code->size();	// Condition check
-
-		emit(OpCode::DUP);					// dupliate the iternator reference, again
-			emit(OpCode::EVAL, 0, lhs->size());	// evaluate the iterator and compare to the limit
-
-		if (inc == 1) {
-			emit(OpCode::PUSH, 0, range->range().max());
-			emit(OpCode::LTE);					// is iterator <= the condition?
-
-		} else {
-			emit(OpCode::PUSH, 0, range->range().min());
-			emit(OpCode::GTE);					// is iterator <= the condition?
-		}
-
-		const auto jmp_pc = emitJNEQI();	// Jump to end of statement if not
+		const Subrange& limits = lhs->base()->range();
+		const int first = inc == 1 ? range->range().min() : range->range().max();
+		int last = inc == 1 ? range->range().max() : range->range().min();
+		const bool checked = lhs->base()->ordinal()
+			&& (range->range().min() < limits.min() || range->range().max() > limits.max());
+		if (checked)						// stop at the iterators limit...
+			last = inc == 1 ? min(last, limits.max()) : max(last, limits.min());
+
+		emit(OpCode::PUSH, 0, last);
+		const size_t pc = emit(OpCode::PUSH, 0, first);
+		if (lhs->base()->ordinal() && limits != TypeDesc::maxRange)
+			emitLimits(limits, pc);
+		emit(OpCode::FORINIT);				// initialize the iterator
+
+		const auto body_pc = code->size();	// Loop body
+
+		// Subroutines deferred by a lazy compilation are compiled after the program body, so any
+		// of them may write to a program level variable...
+		const bool known =	var->second.kind() == SymValue::Variable
+						&&	var->second.level() == level
+						&&	!var->second.type()->ref()
+						&&	!(lazily && level == 0)
+						&&	nonLocalWrites.find(&var->second) == nonLocalWrites.end();
+		if (known)
+			iterators[&var->second] = range->range();
 
 		expect(Token::Loop);				// ... loop statements...
+		++branches;
 		statementList(level, context);
+		--branches;
 		expect(Token::Endloop);				// ... endloop
 
-		emit(OpCode::DUP);					// iterate; dupliate the iternator reference again
-		emit(OpCode::DUP);					// and one more time
-		emit(OpCode::EVAL, 0, 1);			// add (or subtract 1)
-		emit(OpCode::PUSH, 0, inc);
-		emit(OpCode::ADD);
-		emit(OpCode::ASSIGN, 0, 1);			// update the iterator
-		emitJumpI(cond_pc);					// jump back to check the condition again
+		iterators.erase(&var->second);
+		if (known && branches == 0)
+			assigned.insert(&var->second);
 
-		// pop the condition varaible off the stack...
-		const auto done_pc = emit(OpCode::POP, 0, 1);
+		emit(OpCode::FORNEXT, inc, body_pc); // step the iterator, and loop until done
 
-		if (verbose)
-			cout << prefix(progName) << "patching address @ " << done_pc << " to " << code->size() << '\n';
-		(*code)[jmp_pc].value = done_pc;
+		if (checked && last != (inc == 1 ? range->range().max() : range->range().min())) {
+			emit(OpCode::PUSH, 0, last + inc);	// ... and then fail the next step
+			emit(OpCode::LLIMIT, 0, limits.min());
+			emit(OpCode::ULIMIT, 0, limits.max());
+			emit(OpCode::POP, 0, 1);
+		}
 
 		return true;
 	}
@@ -1458,10 +2544,13 @@ bool PComp::returnStatement(int level, SymbolTableEntry& context) {
 
 			// Emit the r-value and assign to the function return in the frame
 
+			const size_t pc = code->size();
 			TDescPtr rtype = expression(level);
-			assignPromote(type->base(), rtype);
-			emit(OpCode::ASSIGN, 0, type->base()->size());
-			emit(OpCode::RETF, 0, context.second.params().size());
+			if (!tailCall(SymValue::Function, context.second.type(), context.second)) {
+				assignPromote(type->base(), rtype, pc);
+				emit(OpCode::ASSIGN, 0, type->base()->size());
+				emit(OpCode::RETF, 0, context.second.params().size());
+			}
 			context.second.returned(true);
 			return true;
 
@@ -1485,9 +2574,14 @@ bool PComp::returnStatement(int level, SymbolTableEntry& context) {
  * @param	level	The current block level.
  ************************************************************************************************/
 void PComp::getStatement(int level) {
-	TDescPtr type;
 	if (accept(Token::OpenParen)) {			// process each expr-tuple..
 		TDescPtr type = expression(level, true); // lvalue(s) to put
+
+		// Check values read into sub-range variables
+		const bool check = type->ordinal() && type->range() != TypeDesc::maxRange;
+		if (check)
+			emit(OpCode::DUP);
+
 		emit(OpCode::PUSH, 0, type->size());
 		expect(Token::CloseParen);
 
@@ -1509,6 +2603,13 @@ void PComp::getStatement(int level) {
 		default:
 			error("unsupported nullptr parameter");
 		}
+
+		if (check) {
+			emit(OpCode::EVAL, 0, 1);
+			emit(OpCode::LLIMIT, 0, type->range().min());
+			emit(OpCode::ULIMIT, 0, type->range().max());
+			emit(OpCode::POP, 0, 1);
+		}
 	}
 }
 
@@ -1595,7 +2696,7 @@ void PComp::statementNew(int level) {
 	expect(Token::OpenParen);
 
 	if (expect(Token::Identifier, false)) {
-		auto it = lookup(ts.current().string_value);
+		auto it = lookup(ts.current().atom);
 		next();								// consume the identifier
 
 		TDescPtr tdesc = TypeDesc::newIntDesc();
@@ -1715,7 +2816,7 @@ void PComp::constDeclList(int level) {
  * @param	var		True if type is a var parameter
  ************************************************************************************************/
 void PComp::typeDecl(int level, bool var) {
-	const string ident = nameDecl(level);			// Copy the identifier
+	const Atom ident = nameDecl(level);				// Copy the identifier
 	expect(Token::Is);								// Consume the "is"
 	TDescPtr tdesc = type(level, var, ident);
 
@@ -1781,7 +2882,7 @@ int PComp::varDeclBlock(int level) {
 	FieldVec	idents;							// vector of name/type pairs.
 
 	if (accept(Token::VarDecl))
-		varDeclList(level, false, "", idents);
+		varDeclList(level, false, Atom(), idents);
 
 	int sum = 0;								// Add up the size of every variable in the block
 	for (const auto& id : idents)
@@ -1804,7 +2905,7 @@ int PComp::varDeclBlock(int level) {
  *
  * @return  Offset of the next variable/parmeter from the current activation frame.
  ************************************************************************************************/
-void PComp::varDeclList(int level, bool params, const string& idprefix, FieldVec& idents) {
+void PComp::varDeclList(int level, bool params, Atom idprefix, FieldVec& idents) {
 	// Stops if the ';' if followd by any of hte following tokens
 	static const Token::KindSet stops {
 		Token::ProcDecl,
@@ -1837,12 +2938,10 @@ void PComp::varDeclList(int level, bool params, const string& idprefix, FieldVec
 			    	<< dx	 				<< ", " 
 					<< id.type()->tclass()	<< '\n';
 
-		auto range = symtbl.equal_range(id.name());	// Already defined?
-		for (auto it = range.first; it != range.second; ++it)
-			if (it->second.level() == level)
-				error("previously defined", id.name());
+		if (symtbl.defined(id.name(), level))		// Already defined?
+			error("previously defined", id.name());
 
-		symtbl.insert( { id.name(), SymValue::makeVar(level, dx, id.type())	} );
+		assigned.erase(&symtbl.insert( { id.name(), SymValue::makeVar(level, dx, id.type())	} )->second);
 		dx += id.type()->size();
 	}
 }
@@ -1866,8 +2965,8 @@ void PComp::varDeclList(int level, bool params, const string& idprefix, FieldVec
  *
  * @param[in,out]	idents	Vector of identifer, kind pairs
  ************************************************************************************************/
-void PComp::varDecl(int level, bool var, const string& idprefix, FieldVec& idents) {
-	vector<string> ids = identifierList(level, idprefix);
+void PComp::varDecl(int level, bool var, Atom idprefix, FieldVec& idents) {
+	vector<Atom> ids = identifierList(level, idprefix);
 	expect(Token::Colon);
 	TDescPtr tdesc = type(level, var, idprefix);
 	for (auto& id : ids)
@@ -1881,8 +2980,8 @@ void PComp::varDecl(int level, bool var, const string& idprefix, FieldVec& ident
  *
  * @return	List of identifiers in the identifier-lst
  ************************************************************************************************/
-vector<string> PComp::identifierList(int level, const string& idprefix) {
-	vector<string> ids;
+vector<Atom> PComp::identifierList(int level, Atom idprefix) {
+	vector<Atom> ids;
 
 	do {
 		ids.push_back(nameDecl(level, idprefix));
@@ -1903,21 +3002,19 @@ vector<string> PComp::identifierList(int level, const string& idprefix) {
  *
  * @return the type description
  ************************************************************************************************/
-TDescPtr PComp::type(int level, bool var, const string& idprefix) {
+TDescPtr PComp::type(int level, bool var, Atom idprefix) {
 	TDescPtr tdesc = TypeDesc::newIntDesc();
 
 	if (accept(Token::Identifier, false)) { 	// previously defined type-name
-		const string id = ts.current().string_value;
+		const Atom id = ts.current().atom;
 		auto it = lookup(id);
 		next();									// Consume the identifier...
 
 		if (it == symtbl.end() || it->second.kind() != SymValue::Type)
 			error("expected type, got ", id);
 
-		else {
-			tdesc = TypeDesc::clone(it->second.type());
-			tdesc->ref(var);
-		}
+		else
+			tdesc = TypeDesc::newRefDesc(it->second.type(), var);
 
 	} else if (accept(Token::Caret)) 			// Pointer type
 		tdesc = TypeDesc::newPointerDesc(type(level, var, idprefix), var);
@@ -1942,10 +3039,10 @@ TDescPtr PComp::type(int level, bool var, const string& idprefix) {
  * @return the type description
  ************************************************************************************************/
 TDescPtr PComp::simpleType(int level, bool var) {
-	TDescPtr type;
+	TDescPtr type = 0;
 
 	if (accept(Token::Identifier, false)) {		// Previously defined type, including real
-		const string id = ts.current().string_value;
+		const Atom id = ts.current().atom;
 		next();									// Consume the identifier
 
 		auto it = lookup(id);
@@ -1955,10 +3052,8 @@ TDescPtr PComp::simpleType(int level, bool var) {
 		else if (it->second.type()->tclass() != TypeDesc::Real)
 			error("expected real, got ", id);
 
-		else {
-			type = it->second.type();
-			type->ref(var);
-		}
+		else
+			type = TypeDesc::newRefDesc(it->second.type(), var);
 
 	} else 
 		type = ordinalType(level, var);
@@ -1997,10 +3092,10 @@ TDescPtrVec PComp::ordinalTypeList(int level, bool var) {
  * @return type description if successful, null pointer otherwise
  ************************************************************************************************/
 TDescPtr PComp::ordinalType(int level, bool var) {
-	TDescPtr type;
+	TDescPtr type = 0;
 
 	if (accept(Token::Identifier, false)) { 	// previously defined type-name
-		const string id = ts.current().string_value;
+		const Atom id = ts.current().atom;
 		auto it = lookup(id);
 		next();									// Consume the identifier...
 
@@ -2010,32 +3105,28 @@ TDescPtr PComp::ordinalType(int level, bool var) {
 		else if (!it->second.type()->ordinal())
 			error("expected ordinal type, got ", it->first);
 
-		else {
-			type = TypeDesc::clone(it->second.type());
-			type->ref(var);
-		}
+		else
+			type = TypeDesc::newRefDesc(it->second.type(), var);
 
 	} else if (accept(Token::OpenParen)) {		// Enumeration
 		FieldVec		enums;
 
-		const auto ids = identifierList(level, "");
+		const auto ids = identifierList(level, Atom());
 		Subrange r(0, ids.empty() ? 0 : ids.size()-1);
 		expect(Token::CloseParen);
 
-		// Create the type, excluding the fields (enumerations)
-		type = TypeDesc::newEnumDesc(r, FieldVec(), var);
+		for (auto id : ids)						// The fields are the enumeration names
+			enums.push_back( { id, TDescPtr() } );
+		type = TypeDesc::newEnumDesc(r, enums, var);
 
 		int value = 0;							// Each enumeration gets a value...
 		for (auto id : ids) {
-			enums.push_back( { id, type } );
 			symtbl.insert(	{ id, SymValue::makeConst(level, Datum(value), type) }	);
 			if (verbose)
 				cout << prefix(progName) << "enumeration '" << id << "' = " << value << ", " << level << '\n';
 			++value;
 		}
 
-		type->fields(enums);
-
 	} else 
 		type = subRangeType(var);
 
@@ -2050,7 +3141,7 @@ TDescPtr PComp::ordinalType(int level, bool var) {
  * @return type description if successful, null pointer otherwise
  ************************************************************************************************/
 TDescPtr PComp::subRangeType(bool var) {
-	TDescPtr type;
+	TDescPtr type = 0;
 
 	auto minValue = constExpr();
 	if (minValue.first) {
@@ -2094,31 +3185,28 @@ TDescPtr PComp::subRangeType(bool var) {
  *
  * @return type description if successful, null pointer otherwise
  ************************************************************************************************/
-TDescPtr PComp::structuredType(int level, const string& idprefix, bool var) {
+TDescPtr PComp::structuredType(int level, Atom idprefix, bool var) {
 	TDescPtr tdesc = 0;
 
 	if (accept(Token::Array)) {					// Array
 		expect(Token::OpenBrkt);				// "["
 
-		TDescPtr tp;
 		TDescPtrVec indexes = ordinalTypeList(level, var);
-		for (auto index : indexes) {
-			const Subrange r = index->range();
-			tdesc = TypeDesc::newArrayDesc(r.span(), r, index, TDescPtr(), var);
-			if (tp == 0)						// Remember the first array type descriptior...
-				tp = tdesc;
-
-			else {								// Following indexes...
-				tp->size(tp->size() * r.span());
-				tp = tp->base();
-			}
-		}
 
 		expect(Token::CloseBrkt);				// "] of"
 		expect(Token::Of);
 
-		tp->base(type(level, var, ""));			// Get the array's base type
-		tp->size(tp->size() * tp->base()->size());
+		tdesc = type(level, var);			// Get the array's base type
+		if (tdesc == nullptr)
+			tdesc = TypeDesc::newIntDesc();
+
+		// array [i1, i2] of T is array [i1] of array [i2] of T; build it from the last index
+		for (auto it = indexes.rbegin(); it != indexes.rend(); ++it) {
+			if (*it == nullptr)
+				continue;
+			const Subrange r = (*it)->range();
+			tdesc = TypeDesc::newArrayDesc(r.span() * tdesc->size(), r, *it, tdesc, var);
+		}
 
 	} else if (accept(Token::Record)) {			// Record
 		FieldVec	fields;
@@ -2145,15 +3233,14 @@ TDescPtr PComp::structuredType(int level, const string& idprefix, bool var) {
  *
  * @return  Offset of the next variable/parmeter from the current activicaqtion frame.
  ************************************************************************************************/
-void PComp::fieldList(int level, const string& idprefix, FieldVec& fields) {
+void PComp::fieldList(int level, Atom idprefix, FieldVec& fields) {
 	varDeclList(level, false, idprefix, fields);
 
 	for (auto& fld : fields) {					// trim off the prefix '.' from the identifiers
-		size_t n = fld.name().find('.');
-		if (n != string::npos && n < fld.name().size()) {
-			string name = fld.name();
-			fld.name(name.erase(0, n+1));
-		}
+		const string& name = fld.name();
+		size_t n = name.find('.');
+		if (n != string::npos && n < name.size())
+			fld.name(Atom(name.substr(n+1)));
 	}
 }
 
@@ -2175,7 +3262,7 @@ void PComp::fieldList(int level, const string& idprefix, FieldVec& fields) {
 void PComp::paramDeclList(
 			int			level,
 			bool		params,
-	const	string&		idprefix,
+			Atom		idprefix,
 			FieldVec&	idents)
 {
 	// Stops if the ';' if followd by any of hte following tokens
@@ -2218,12 +3305,11 @@ void PComp::paramDeclList(
 				 << boolalpha			<< id.type()->ref()
 				 << '\n';
 
-		auto range = symtbl.equal_range(id.name());	// Already defined?
-		for (auto it = range.first; it != range.second; ++it)
-			if (it->second.level() == level)
-				error("previously defined", id.name());
+		if (symtbl.defined(id.name(), level))		// Already defined?
+			error("previously defined", id.name());
 
-		symtbl.insert( { id.name(), SymValue::makeVar(level, dx, id.type())	} );
+		// Value parameters are checked by the caller...
+		assigned.insert(&symtbl.insert( { id.name(), SymValue::makeVar(level, dx, id.type())	} )->second);
 		dx += id.type()->size();
 	}
 }
@@ -2242,6 +3328,7 @@ void PComp::paramDeclList(
 SymbolTableIter PComp::subroutineDecl(int level, SymValue::Kind kind) {
 	auto ident = nameDecl(level);			// insert the name into the symbol table
 	SymbolTableIter	it = symtbl.insert( { ident, SymValue::makeSbr(kind, level)	} );
+	bodies.erase(&it->second);				// Forget any purged subroutine that lived here
 	if (verbose)
 		cout << prefix(progName) << "subroutineDecl " << ident << ": " << level << ", 0\n";
 
@@ -2249,7 +3336,7 @@ SymbolTableIter PComp::subroutineDecl(int level, SymValue::Kind kind) {
 		FieldVec	idents;					// vector of name/type pairs.
 
 		// Note that the activation frame level is that of the *following* block!
-		paramDeclList(level+1, true, "", idents);
+		paramDeclList(level+1, true, Atom(), idents);
 
 		expect(Token::CloseParen);
 
@@ -2260,6 +3347,42 @@ SymbolTableIter PComp::subroutineDecl(int level, SymValue::Kind kind) {
 	return it;
 }
 
+/********************************************************************************************//**
+ * In lazy mode, the body of a subroutine declared in the program block is skipped, up to, and
+ * including, it's end token, and a stub is emitted in it's place, which compiles it when first
+ * called. Calls reached in the meantime call the stub. The subroutine's parameters are saved, as
+ * they're purged, for when the body is compiled.
+ *
+ * @param	it		The subroutine, whose heading has been compiled
+ * @param	level	The current block level
+ * @param	end		The end of block token
+ * @return	true if the body was deferred
+ ************************************************************************************************/
+bool PComp::defer(SymbolTableIter it, int level, Token::Kind end) {
+	if (!lazily || level != 0)
+		return false;
+
+	Deferred sub { it, {}, ts.mark(), 0 };
+	for (auto param : symtbl.scope(level + 1))
+		sub.params.push_back(*param);
+	purge(level + 1);
+
+	for (int depth = 0; current() != Token::EOS; next())	// Skip the body, and nested subroutines
+		if (current() == Token::ProcDecl || current() == Token::FuncDecl)
+			++depth;
+		else if ((current() == Token::Endproc || current() == Token::Endfunc) && depth-- == 0)
+			break;
+	expect(end);
+
+	sub.stub = emit(OpCode::COMPILE, 0, deferred.size());
+	it->second.value(Datum(sub.stub));
+	deferred.push_back(sub);
+	if (verbose)
+		cout << prefix(progName) << "deferring " << it->first << " to " << sub.stub << '\n';
+
+	return true;
+}
+
 /********************************************************************************************//**
  * procedure ident [ ( var-decl-lst ) ] ; block ;
  *
@@ -2268,8 +3391,21 @@ SymbolTableIter PComp::subroutineDecl(int level, SymValue::Kind kind) {
 void PComp::procDecl(int level) {
 	SymbolTableIter it = subroutineDecl(level, SymValue::Procedure);
 	expect(Token::Is);
+	if (!defer(it, level, Token::Endproc))
+		procBody(it, level);
+}
+
+/********************************************************************************************//**
+ * block ;
+ *
+ * @param	it		The procedure
+ * @param	level	The current block level.
+ ************************************************************************************************/
+void PComp::procBody(SymbolTableIter it, int level) {
 	blockDecl(*it, level + 1, Token::Endproc);
+	tailCall(SymValue::Procedure, nullptr, it->second);
 	emit(OpCode::RET, 0, it->second.params().size());
+	inlinable(it->second, code->size());
 }
 
 /********************************************************************************************//**
@@ -2280,11 +3416,23 @@ void PComp::procDecl(int level) {
 void PComp::funcDecl(int level) {
 	SymbolTableIter it = subroutineDecl(level, SymValue::Function);
 	expect(Token::Colon);
-	it->second.type(type(level, false, ""));
+	it->second.type(type(level, false));
 	expect(Token::Is);
+	if (!defer(it, level, Token::Endfunc))
+		funcBody(it, level);
+}
+
+/********************************************************************************************//**
+ * block-decl ;
+ *
+ * @param	it		The function
+ * @param	level	The current block level.
+ ************************************************************************************************/
+void PComp::funcBody(SymbolTableIter it, int level) {
 	blockDecl(*it, level + 1, Token::Endfunc);
 	if (!it->second.returned())
 		error("Funcation has no return statement");
+	inlinable(it->second, code->size());
 }
 
 /********************************************************************************************//**
@@ -2335,18 +3483,32 @@ size_t PComp::blockDecl(SymbolTableEntry& context, int level, Token::Kind end) {
 	/* Block body
 	 *
 	 * Emit the block's prefix, saving and return its address, followed by the postfix. Omit the prefix
-	 * if dx == 0 (the subroutine has zero locals).
+	 * if dx == 0 (the subroutine has zero locals), unless inlined subroutines may need it; their
+	 * parameters and locals are allocated following ours, and the prefix is patched once they're known.
 	 */
 
-	const size_t addr = dx > 0 ? emit(OpCode::ENTER, 0, dx) : code->size();
+	const size_t addr = dx > 0 || limit > 0 ? emit(OpCode::ENTER, 0, dx) : code->size();
 	context.second.value(Datum(addr));
+	frames.push_back(Frame{addr, FrameSize + dx, FrameSize + dx});
+
+	auto calls = unresolved.find(&context.second);	// Patch calls from nested subroutines
+	if (calls != unresolved.end()) {
+		for (auto pc : calls->second)
+			(*code)[pc].value = addr;
+		unresolved.erase(calls);
+	}
 
 	if (expect(Token::Begin)) {					// "begin" statements... "end"
 		statementList(level, context);
 		expect(end);
 	}
 
-	purge(level);								// Remove symbols only visible at this level
+	if (frames.back().high > FrameSize + dx)
+		(*code)[frames.back().enter].value = frames.back().high - FrameSize;
+	frames.pop_back();
+
+	if (level > 0 || deferred.empty())			// Deferred subroutines need the program's symbols
+		purge(level);							// Remove symbols only visible at this level
 
 	return addr;
 }
@@ -2376,14 +3538,26 @@ void PComp::progDecl() {
 
 /********************************************************************************************//**
  ************************************************************************************************/
-void PComp::run()								{	progDecl();	}
+void PComp::run() {
+	progDecl();
+
+	if (verbose) {
+		cout << prefix(progName) << "removed " << nLimitsRemoved << " of " << nLimits
+			 << " limit checks\n";
+		cout << prefix(progName) << TypeDesc::nTypes() << " distinct types\n";
+		cout << prefix(progName) << Atom::size() << " atoms\n";
+	}
+}
 
 // public:
 
 /********************************************************************************************//**
  * Construct a new compilier with the token stream initially bound to std::cin.
  ************************************************************************************************/
-PComp::PComp() : Compilier () {
+PComp::PComp()
+	: Compilier (), branches{0}, limit{0}, nLimits{0}, nLimitsRemoved{0}, junction{OpCode::HALT, 0, 0, {}, false, false}, unfoldable{0}, target{0},
+	  lastCall{0, SymValue::None, nullptr, 0, false}, lvalue{0, 0}, lazily{false}
+{
 	TDescPtr boolean	= TypeDesc::newBoolDesc();
 	TDescPtr character	= TypeDesc::newCharDesc();
 	TDescPtr integer	= TypeDesc::newIntDesc();
@@ -2393,23 +3567,60 @@ PComp::PComp() : Compilier () {
 
 	// Insert built-in types into the symbol table
 
-	symtbl.insert( { "boolean",		SymValue::makeType(0, boolean)					} );
-	symtbl.insert( { "integer",		SymValue::makeType(0, integer)					} );
-	symtbl.insert( { "real",		SymValue::makeType(0, real)						} );
+	symtbl.insert( { Atom("boolean"),		SymValue::makeType(0, boolean)					} );
+	symtbl.insert( { Atom("integer"),		SymValue::makeType(0, integer)					} );
+	symtbl.insert( { Atom("real"),			SymValue::makeType(0, real)						} );
 
 	// Built-in subrange types
 
-	symtbl.insert( { "character",	SymValue::makeType(0, character)				} );
-	symtbl.insert( { "natural",		SymValue::makeType(0, natural) 					} );
-	symtbl.insert( { "positive",	SymValue::makeType(0, positive) 				} );
+	symtbl.insert( { Atom("character"),		SymValue::makeType(0, character)				} );
+	symtbl.insert( { Atom("natural"),		SymValue::makeType(0, natural) 					} );
+	symtbl.insert( { Atom("positive"),		SymValue::makeType(0, positive) 				} );
 
 	// Built-in constants into the symbol table; id, level (always zero), and value
 
-	symtbl.insert({"true",   		SymValue::makeConst(0, Datum(true), boolean)	} );
-	symtbl.insert({"false",  		SymValue::makeConst(0, Datum(false), boolean)	} );
-	symtbl.insert({"nil",    		SymValue::makeConst(
+	symtbl.insert({Atom("true"),			SymValue::makeConst(0, Datum(true), boolean)	} );
+	symtbl.insert({Atom("false"),			SymValue::makeConst(0, Datum(false), boolean)	} );
+	symtbl.insert({Atom("nil"),				SymValue::makeConst(
 										0,
 										Datum(0),
 										TypeDesc::newPointerDesc(integer))			} );
 }
 
+/********************************************************************************************//**
+ * Resume compiling at the body of deferred subroutine n, with it's parameters, and program's
+ * symbols, in scope. The subroutine's code is appended to the program, and then it's stub is
+ * patched to jump to it, along with the calls to the stub, so they call it directly.
+ *
+ * @param		n		The deferred subroutine, i.e., the stub's value
+ * @param[out]	entry	The subroutine's entry address
+ * @return	false if n isn't deferred, or it's body has errors
+ ************************************************************************************************/
+bool PComp::load(size_t n, size_t& entry) {
+	if (n >= deferred.size())
+		return false;
+
+	const Deferred& sub = deferred[n];
+	const unsigned errors = nErrors;
+	ts.restore(sub.body);
+	for (const auto& param : sub.params)
+		symtbl.insert(param);
+
+	if (verbose)
+		cout << prefix(progName) << "compiling " << sub.it->first << '\n';
+	if (sub.it->second.kind() == SymValue::Function)
+		funcBody(sub.it, 0);
+	else
+		procBody(sub.it, 0);
+
+	if (errors != nErrors)
+		return false;
+
+	entry = sub.it->second.value().natural();
+	(*code)[sub.stub] = Instr(OpCode::JUMPI, 0, Datum(entry));
+	for (auto& instr : *code)
+		if ((instr.op == OpCode::CALLI || instr.op == OpCode::TCALLI) && instr.value.natural() == sub.stub)
+			instr.value = entry;
+
+	return true;
+}
@@ -10,7 +10,11 @@
 #ifndef	PCOMP_H
 #define	PCOMP_H
 
+#include <map>
+#include <set>
+
 #include "compilier.h"
+#include "loader.h"
 
 /********************************************************************************************//**
  * A P Compilier
@@ -22,13 +26,108 @@
  * run via the call operator, specifing the input stream, the location of the emitted code, and
  * wheather to emit a travlelog (verbose messages).
  ************************************************************************************************/
-class PComp : public Compilier {
+class PComp : public Compilier, public Loader {
 public:
 	PComp();								///< Constructor
 
+	/// Inline subroutines of up to n instructions; zero for none
+	void inlineLimit(unsigned n)			{	limit = n;	}
+
+	/// Defer compiling subroutines declared in the program block until they're first called?
+	void lazy(bool on)						{	lazily = on;	}
+
+	/// Compile deferred subroutine n, returning it's entry address...
+	bool load(size_t n, size_t& entry) override;
+
+	/// Return the address of each call site's call, in the order they were compiled
+	const std::vector<size_t>& callSites() const	{	return sites;	}
+
 private:
+	static const unsigned hotLimit = 4;		///< Hot call sites may inline subroutines this much larger
+	static const size_t noBase = ~size_t(0);	///< No variable reference to fold offsets into
+
+	/// Value ranges, indexed by the address of the instruction that loaded the value
+	typedef std::map<size_t, Subrange> RangeIndex;
+
+	/// Variable value ranges, indexed by the variables symbol table value
+	typedef std::map<const SymValue*, Subrange> VarRanges;
+
+	/// Call instruction addresses, indexed by the callee's symbol table value
+	typedef std::map<const SymValue*, std::vector<size_t>> CallSites;
+
+	/// The body of a subroutine that may be inlined
+	struct Body {
+		size_t				begin;		///< Address of the first instruction, following any ENTER
+		size_t				end;		///< Address following the last instruction
+		int					locals;		///< Number of local Datums
+	};
+
+	/// Subroutine bodies that may be inlined, indexed by their symbol table value
+	typedef std::map<const SymValue*, Body> Bodies;
+
+	/// The frame of a block being compiled, that inlined subroutines allocate slots in
+	struct Frame {
+		size_t				enter;		///< Address of the block's ENTER
+		int					next;		///< Offset of the next free slot
+		int					high;		///< Offset following the highest slot used
+	};
+
+	/// A short-circuit and/or expression, or chain of them, e.g., a and b and c
+	struct ShortCircuit {
+		OpCode				op;			///< OpCode::AND or OpCode::OR
+		size_t				begin;		///< Address of the first operand
+		size_t				end;		///< Address following the expression
+		std::vector<size_t>	exits;		///< Addresses of the early exits
+		bool				known;		///< The left operand is known at compile time...
+		bool				value;		///< ...and this is it's value
+	};
+
+	/// The code of an assignment's left-hand-side, whose address it's right-hand-side may reuse
+	struct Lvalue {
+		size_t				begin;		///< Address of the first instruction
+		size_t				end;		///< Address following the last, the right-hand-side's
+	};
+
+	/// A subroutine whose body is compiled when it's first called
+	struct Deferred {
+		SymbolTableIter		it;			///< The subroutine
+		std::vector<SymbolTableEntry> params;	///< It's parameters
+		TokenStream::Mark	body;		///< The start of it's body
+		size_t				stub;		///< Address of it's COMPILE stub
+	};
+
+	/// A call, that may become a tail call
+	struct Call {
+		size_t				pc;			///< Address of the CALLI
+		SymValue::Kind		kind;		///< The callee's kind, Procedure or Function
+		TDescPtr			type;		///< The callee's return type, if a function
+		size_t				nParams;	///< The callee's number of parameters
+		bool				tail;		///< May the callee reuse the caller's frame?
+	};
+
+	RangeIndex				ranges;			///< Known value ranges of emitted evaluations
+	VarRanges				iterators;		///< Active for-loop iterator ranges
+	std::set<const SymValue*> assigned;		///< Variables known to have been assigned
+	unsigned				branches;		///< Depth of conditional, or repeated, statements
+	CallSites				unresolved;		///< Calls to subroutines whose entry isn't yet known
+	Bodies					bodies;			///< Subroutines that may be inlined
+	std::vector<Frame>		frames;			///< Frames of the blocks being compiled
+	unsigned				limit;			///< Inline subroutines of up to this many instructions
+	std::vector<size_t>		sites;			///< Each call site's call, or none if inlined
+	std::set<const SymValue*> nonLocalWrites; ///< Variables written from nested blocks
+	unsigned				nLimits;		///< Number of limit checks required
+	unsigned				nLimitsRemoved;	///< Number of limit checks proven redundant
+	ShortCircuit			junction;		///< The last short-circuit expression emitted
+	size_t					unfoldable;		///< Just past the last operation that failed to fold
+	size_t					target;			///< The last jump target, which folding may not span
+	Call					lastCall;		///< The last call emitted
+	Lvalue					lvalue;			///< The assignment being compiled, if any
+	bool					lazily;			///< Defer compiling subroutines?
+	std::vector<Deferred>	deferred;		///< Subroutines yet to be compiled, in declaration order
+
 	bool isAnInteger(TDescPtr type);		///< Is type an integer?
 	bool isAReal(TDescPtr type);			///< Is type a Real?
+	bool isScalar(TDescPtr type);			///< Is type a single ordinal value, not an array or record?
 	size_t emitJump(size_t where = 0);		///< Emit a JUMP instruction...
 	size_t emitJumpI(size_t where = 0);		///< Emit a JUMPI instruction...
 	size_t emitJNEQ(size_t where = 0);		///< Emit a JNEQ instruction...
@@ -40,16 +139,61 @@ private:
 	/// Emit a CALLI insruction...
 	size_t emitCallI(int8_t level, size_t where);
 
+	/// Rewrite the last call emitted as a tail call, if it may be...
+	bool tailCall(SymValue::Kind kind, TDescPtr type, const SymValue& caller);
+
+	/// Note sub's body, ending at end, if it may be inlined...
+	void inlinable(const SymValue& sub, size_t end);
+
+	/// Return the largest subroutine that may be inlined at site...
+	unsigned siteLimit(size_t site) const;
+
+	/// Emit a copy of body, whose parameters, return value and locals are in slots...
+	void inlineBody(int depth, const Body& body, int slots, size_t nParams, bool function);
+
 	/// Promote data type if necessary...
 	TDescPtr promote(TDescPtr lhs, TDescPtr rhs);
 
 	/// Promote assigned data type if necessary...
-	void assignPromote (TDescPtr lhs, TDescPtr rhs);
+	void assignPromote (TDescPtr lhs, TDescPtr rhs, size_t pc);
+
+	/// Evaluate an instruction on a compile-time stack...
+	bool foldInstr(const Instr& instr, DatumVector& stack);
+
+	/// Replace code[pc..] with a single push, if it's value is known at compile time...
+	bool fold(size_t pc);
+
+	void retract(size_t pc) override;		///< Discard instructions emitted from pc on...
+
+	/// Return the range of code[pc..]'s value, if known...
+	bool rangeOf(size_t pc, Subrange& range);
+
+	/// Emit limit checks for code[pc..]'s value, unless proven redundant...
+	void emitLimits(const Subrange& limits, size_t pc);
+
+	/// Note a write to, or a reference that could write to, a variable...
+	void written(int level, SymbolTableIter it);
+
+	/// Emit the early exit following the left operand of a short-circuit and/or...
+	ShortCircuit shortCircuit(size_t pc, OpCode op);
+
+	/// Complete a short-circuit and/or following it's right operand...
+	void shortCircuitEnd(const ShortCircuit& sc);
+
+	/// Patch the jumps at pcs to jump to where
+	void patch(const std::vector<size_t>& pcs, size_t where);
+
+	/// Reuse the assignment's address, instead of the variable reference at pc, if it may be...
+	void reuseLvalue(size_t pc);
+
+	/// Fold a constant into the variable reference at base, if it may be...
+	bool rebase(size_t base, long long offset);
 
 	/// array index production...
 	TDescPtr varArray(	int					level,
 						SymbolTableIter		it,
-						TDescPtr			type);
+						TDescPtr			type,
+						size_t				base);
 
 	/// Attribute production...
 	TDescPtr attribute(	SymbolTableIter	it,
@@ -57,7 +201,8 @@ private:
 
 	/// Record selection production...
 	TDescPtr varSelector(SymbolTableIter	it,
-						TDescPtr			type);
+						TDescPtr			type,
+						size_t				base);
 
 	/// variable sub-production...
 	TDescPtr variable(	int					level,
@@ -67,7 +212,7 @@ private:
 
 	/// factor-identifier sub-production...
 	TDescPtr identFactor(int				level,
-				const	std::string&		id,
+						Atom				id,
 						bool				var);
 
 	TDescPtr factor(int level, bool var);	///< factor production...
@@ -82,6 +227,9 @@ private:
 
 	TDescPtrVec	expressionList(int level);	///< expression-list production...
 
+	/// Boolean expression that controls an if, elif, while or until...
+	std::vector<size_t> condition(int level);
+
 	/// A constant expression value. Second is valid if first is true
 	typedef std::pair<bool,Datum> ConstExprValue;
 
@@ -102,6 +250,9 @@ private:
 	/// Evaluate and emit a l-value reference...
 	TDescPtr lvalueRef(int level, SymbolTableIter it, bool dup);
 
+	/// compound-assignment production, e.g., variable += expression...
+	bool compoundAssign(int level, TDescPtr type, bool known);
+
 	/// assignment-statement production...
 	void assignStatement(	int				level,
 							SymbolTableIter	it,
@@ -146,24 +297,24 @@ private:
 	/// variable-declaration-list production...
 	void varDeclList(	int					level,
 						bool				params,
-				const	std::string&		idprefix,
+						Atom				idprefix,
 						FieldVec&			idents);
 
 	/// variable-declaration production...
 	void varDecl(		int					level,
 						bool				var,
-				const	std::string&		idprefix,
+						Atom				idprefix,
 						FieldVec&			idents);
 
 	/// identifier-lst production...
-	std::vector<std::string> identifierList(
+	std::vector<Atom> identifierList(
 						int					level,
-				const	std::string&		idprefix);
+						Atom				idprefix);
 
 	/// type productions...
 	TDescPtr type(		int 				level,
 						bool				var,
-				const	std::string&		idprefix = "");
+						Atom				idprefix = Atom());
 
 	/// simple-type productions...
 	TDescPtr simpleType(int level, bool var);
@@ -178,18 +329,18 @@ private:
 
 	/// structued-type productions...
 	TDescPtr structuredType(int				level,
-				const		std::string&	idprefix,
+							Atom			idprefix,
 							bool			var);
 
 	/// field-list productions...
 	void fieldList(		int					level,
-				const	std::string&		idprefix,
+						Atom				idprefix,
 						FieldVec&			idents);
 
 	/// variable-declaration-list production...
 	void paramDeclList(	int					level,
 						bool				params,
-				const	std::string& 		idprefix,
+						Atom				idprefix,
 						FieldVec&			idents);
 
 	/// Subroutine-declaration production...
@@ -197,8 +348,13 @@ private:
 						int					level,
 						SymValue::Kind		kind);
 
+	/// Skip the body of it, ending with end, and emit a stub in it's place, if it may be...
+	bool defer(SymbolTableIter it, int level, Token::Kind end);
+
 	void procDecl(int level);				///< procedure-declaration production...
+	void procBody(SymbolTableIter it, int level);	///< procedure block production...
 	void funcDecl(int level);				///< function-declaration production...
+	void funcBody(SymbolTableIter it, int level);	///< function block production...
 	void subDeclList(int level);			///< function/procedue declaraction productions...
 
 	/// block-declaration production...
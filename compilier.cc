@@ -8,7 +8,9 @@
  ************************************************************************************************/
 
 #include "compilier.h"
+#include "flow.h"
 #include "interp.h"
+#include "peephole.h"
 
 #include <cassert>
 #include <iomanip>
@@ -90,17 +92,35 @@ void Compilier::error(const std::string& msg, const std::string& name) {
 	error (msg + " '" + name + "'");
 }
 
+/********************************************************************************************//**
+ * Write a diagnostic on standard error output, incrementing the warning count. Unlike an error,
+ * a warning doesn't prevent the program from being run.
+ * @param msg The warning message
+ ************************************************************************************************/
+void Compilier::warning(const std::string& msg) {
+	cerr << progName << ": warning: " << msg << " near line " << ts.lineNum << endl;
+	++nWarnings;
+}
+
 /********************************************************************************************//**
  * @return The next token from the token stream
  ************************************************************************************************/
-Token Compilier::next() {
-	const Token t = ts.get();
+const Token& Compilier::next() {
+	const Token& t = ts.get();
 
 	if (Token::Unknown == t.kind) {
 		ostringstream oss;
 		oss << "Unknown token: '" << t.string_value << "', (0x" << hex << t.integer_value << ")";
 		error(oss.str());
 		return next();
+
+	} else if (Token::BadInteger == t.kind) {
+		error("integer overflow", t.string_value);
+
+		Token& integer = ts.current();		// Carry on with the largest integer
+		integer.kind = Token::IntegerNum;
+		integer.integer_value = numeric_limits<int>::max();
+		return integer;
 	}
 
 	if (verbose)
@@ -168,6 +188,65 @@ size_t Compilier::emit(const OpCode op) {
 	return emit(op, 0, Datum(0));
 }
 
+/********************************************************************************************//**
+ * Discard previously emitted instructions, code[pc..end), along with their cross index entries.
+ *
+ * @param	pc		Address of the first instruction to discard
+ ************************************************************************************************/
+void Compilier::retract(size_t pc) {
+	if (pc < code->size()) {
+		if (verbose)
+			cout << prefix(progName) << "retracting " << pc << ".." << code->size() - 1 << '\n';
+
+		code->resize(pc);
+		indextbl.resize(pc);
+	}
+}
+
+/********************************************************************************************//**
+ * Optimize the emitted code, if requested, and there were no errors. -O1 threads jumps, removes
+ * unreachable code and runs the peephole optimizer, -O2 also merges blocks first, exposing
+ * more peephole patterns. Given a profile, cold blocks are then moved out of the way.
+ *
+ * @param	opt		The optimization level; zero for none
+ * @param	stats	Report per-pass statistics if true
+ ************************************************************************************************/
+void Compilier::optimize(unsigned opt, bool stats) {
+	if (opt > 0 && 0 == nErrors) {
+		PassManager passes(progName, stats || verbose);
+		passes.add(1, new ThreadJumps());
+		passes.add(1, new DeadCode());
+		passes.add(2, new MergeBlocks());
+		passes.add(1, new Peephole(progName, verbose));
+		if (prof)
+			passes.add(1, new HotColdLayout(*prof));
+		passes(opt, *code, indextbl);
+	}
+}
+
+/********************************************************************************************//**
+ * Run the compiler, and then optimize, timing each if timed. Scanning is interleaved with
+ * parsing, so the time spent scanning is moved from parse to lex.
+ *
+ * @param	opt		The optimization level; zero for none
+ * @param	stats	Report per-pass statistics if true
+ ************************************************************************************************/
+void Compilier::compile(unsigned opt, bool stats) {
+	ts.timed(times != nullptr);
+	{
+		Phases::Timer timer(times, Phases::Parse);
+		run();
+	}
+
+	if (times != nullptr) {
+		times->add(Phases::Lex, ts.time());
+		times->add(Phases::Parse, -ts.time());
+	}
+
+	Phases::Timer timer(times, Phases::Optimize);
+	optimize(opt, stats);
+}
+
 /********************************************************************************************//**
  * Local variables have an offset from the *end* of the current stack frame
  * (bp), while parameters have a negative offset from the *start* of the frame
@@ -218,43 +297,30 @@ TDescPtr Compilier::emitVarRef(int level, const SymValue& val) {
  * @param level  The block level
  ************************************************************************************************/
 void Compilier::purge(int level) {
-	for (auto i = symtbl.begin(); i != symtbl.end(); ) {
-		if (i->second.level() == level) {
-			if (verbose)
-				cout	<< prefix(progName)	<< "purging "
-						<< i->first 		<< ": "
-						<< i->second.kind() << ", "
-						<< static_cast<int>(i->second.level()) << ", "
-						<< i->second.value()
-						<< " from the symbol table\n";
-			i = symtbl.erase(i);
-
-		} else
-			++i;
-	}
+	if (verbose)
+		for (auto i : symtbl.scope(level))
+			cout	<< prefix(progName)	<< "purging "
+					<< i->first 		<< ": "
+					<< i->second.kind() << ", "
+					<< static_cast<int>(i->second.level()) << ", "
+					<< i->second.value()
+					<< " from the symbol table\n";
+
+	symtbl.purge(level);
 }
 
-
 /********************************************************************************************//**
  * return the 'closest' (highest block level) identifer...
  *
  * @param	id	identifier to look up in the symbol table
  * @return symtbl.end() or an iterator positioned at a symbol table entry.
  ************************************************************************************************/
-SymbolTable::iterator Compilier::lookup(const string& id) {
-	auto range = symtbl.equal_range(id);
-	if (range.first == range.second) {
+SymbolTable::iterator Compilier::lookup(Atom id) {
+	auto it = symtbl.find(id);
+	if (it == symtbl.end())
 		error("Undefined identifier", id);
-		return symtbl.end();
-
-	} else {										// Find the closest...
-		auto closest = range.first;
-		for (auto it = closest; it != range.second; ++it)
-			if (it->second.level() > closest->second.level())
-				closest = it;
 
-		return closest;
-	}
+	return it;
 }
 
 /********************************************************************************************//**
@@ -273,23 +339,18 @@ SymbolTable::iterator Compilier::lookup(const string& id) {
  * @return	The next, undecorated, identifier in the token stream, "unknown" if the next token
  * 			 wasn't an identifier.
  ************************************************************************************************/
-const std::string Compilier::nameDecl(int level, const string& idprefix) {
-	const string id = ts.current().string_value;	// Copy the identifer before consuming it
-	const string prefixed = idprefix.empty()	? id : idprefix + string(".") + id;
+Atom Compilier::nameDecl(int level, Atom idprefix) {
+	const Atom id = ts.current().atom;				// Copy the identifer before consuming it
+	const Atom prefixed = idprefix.empty() ? id : Atom(idprefix.str() + "." + id.str());
 
 	if (expect(Token::Identifier)) {				// Consume the identifier
-		auto range = symtbl.equal_range(prefixed);	// Already defined?
-		for (auto it = range.first; it != range.second; ++it) {
-			if (it->second.level() == level) {
-				error("previously was defined", prefixed);
-				break;
-			}
-		}
+		if (symtbl.defined(prefixed, level))		// Already defined?
+			error("previously was defined", prefixed);
 
 		return prefixed;
 	}
 
-	return "unknown";
+	return Atom("unknown");
 }
 
 /************************************************************************************************
@@ -299,7 +360,7 @@ const std::string Compilier::nameDecl(int level, const string& idprefix) {
 /********************************************************************************************//**
  * Construct a new compilier with the token stream initially bound to std::cin.
  ************************************************************************************************/
-Compilier::Compilier() : nErrors{0}, verbose {false}, ts{cin} {}
+Compilier::Compilier() : nErrors{0}, nWarnings{0}, verbose {false}, ts{cin}, prof{nullptr}, times{nullptr} {}
 
 /********************************************************************************************//**
  * Compile the contents of fName, generating code in prog.
@@ -308,6 +369,8 @@ Compilier::Compilier() : nErrors{0}, verbose {false}, ts{cin} {}
  * @param	instructions	The generated machine code is appended here
  * @param	lst				Write listing on standard output.
  * @param	ver				Run in verbose mode if true
+ * @param	opt				The optimization level; zero for none
+ * @param	stats			Report optimizer pass statistics if true
  *
  * @return	The number of errors encountered
  ************************************************************************************************/
@@ -315,7 +378,9 @@ unsigned Compilier::operator()(
 	const	string&			fName,
 			InstrVector&	instructions,
 			bool			lst,
-			bool			ver)
+			bool			ver,
+			unsigned		opt,
+			bool			stats)
 {
 	progName = fName;
 	code = &instructions;
@@ -323,9 +388,10 @@ unsigned Compilier::operator()(
 
 	if ("-" == fName)  {					// "-" means standard input
 		ts.set_input(cin);
-		run();
+		compile(opt, stats);
 
 		// Just disasmemble as we can't rewind standard input!
+		Phases::Timer timer(times, Phases::Listing);
 		for (unsigned loc = 0; loc < code->size(); ++loc)
 			disasm(cout, loc, (*code)[loc]);
 
@@ -336,10 +402,11 @@ unsigned Compilier::operator()(
 
 		else {
 			ts.set_input(ifile);
-			run();
+			compile(opt, stats);
 
 			ifile.close();					// Rewind the source (seekg(0) isn't working!)...
 			if (lst) {
+				Phases::Timer timer(times, Phases::Listing);
 				ifile.open(fName);
 				listing(ifile, cout);	// 	create a listing...
 			}
@@ -349,3 +416,13 @@ unsigned Compilier::operator()(
 	return nErrors;
 }
 
+/********************************************************************************************//**
+ * Includes any subroutines compiled lazily, so far.
+ *
+ * @param[out]	p	Where to count the tokens read, symbols declared and types built
+ ************************************************************************************************/
+void Compilier::tally(Phases& p) const {
+	p.count(Phases::Tokens, ts.tokens());
+	p.count(Phases::Symbols, symtbl.inserted());
+	p.count(Phases::Types, TypeDesc::nTypes());
+}
@@ -17,6 +17,8 @@
 
 #include "instr.h"
 #include "datum.h"
+#include "phases.h"
+#include "profile.h"
 #include "symbol.h"
 #include "token.h"
 
@@ -59,6 +61,9 @@ std::ostream& operator<<(std::ostream& oss, LogPrefix p);
  ************************************************************************************************/
 class Compilier {
 public:
+	/// A table, indexed by instruction address, yeilding source line numbers...
+	typedef std::vector<unsigned> SourceIndex;
+
 	Compilier();							///< Constructor...
 	virtual ~Compilier() {}					///< Destructor...
 
@@ -67,29 +72,48 @@ public:
 		const	std::string&	fName,
 				InstrVector&	instructions,
 				bool			lst,
-				bool			ver);
+				bool			ver,
+				unsigned		opt = 0,
+				bool			stats = false);
 
-protected:
-	/// A table, indexed by instruction address, yeilding source line numbers...
-	typedef std::vector<unsigned> SourceIndex;
+	/// Return the source cross-index of the emitted code
+	const SourceIndex& sourceIndex() const	{	return indextbl;	}
+
+	/// Guide optimizations with a training run's profile, or none if nullptr
+	void profile(const Profile* p)			{	prof = p;	}
 
+	/// Time the compile's phases into p, or don't if nullptr
+	void phases(Phases* p)					{	times = p;	}
+
+	/// Count the tokens, symbols and types compiled into p
+	void tally(Phases& p) const;
+
+	/// Return the number of warnings written
+	unsigned warnings() const				{	return nWarnings;	}
+
+protected:
 	std::string			progName;			///< The compilier's name, used in error messages
 	unsigned			nErrors;			///< Total # of compilier errors
+	unsigned			nWarnings;			///< Total # of compilier warnings
 	bool				verbose;			///< Dump debugging information if true
 	TokenStream			ts;					///< The input token stream (the source)
 	SymbolTable			symtbl;				///< Symbol table
 	InstrVector*		code;				///< Emitted code
 	SourceIndex			indextbl;			///< Source cross-index for listings
+	const Profile*		prof;				///< A training run's profile, if any
+	Phases*				times;				///< Phase times, if timed
 
 	void error(const std::string& msg);		///< Write an error message...
 
 	/// Write an error message...
 	void error(const std::string& msg, const std::string& name);
 
+	void warning(const std::string& msg);	///< Write a warning message...
+
 	/// Return the current token kind...
 	Token::Kind current() 					{	return ts.current().kind;	}
 
-	Token next();							///< Read and return the next token...
+	const Token& next();					///< Read and return the next token...
 
 	/// Accept the next token if it's a k...
 	bool accept(Token::Kind k, bool get = true);
@@ -103,6 +127,10 @@ protected:
 	/// Emit an instruction...
 	template <class T> size_t emit(const OpCode op, int8_t level, const T& addr);
 
+	virtual void retract(size_t pc);		///< Discard instructions emitted from pc on...
+	void optimize(unsigned opt, bool stats);	///< Optimize the emitted code...
+	void compile(unsigned opt, bool stats);	///< Compile, and optimize, timing each...
+
 	/// Emit a variable reference, e.g., an absolute address...
 	TDescPtr emitVarRef(int level, const SymValue& val);
 
@@ -113,10 +141,10 @@ protected:
 	void purge(int level);
 
 	/// lookup identifier in the symbol table...
-	SymbolTable::iterator lookup(const std::string& id);
+	SymbolTable::iterator lookup(Atom id);
 
 	/// name (identifier) check...
-	const std::string nameDecl(int level, const std::string& idprefix = "");
+	Atom nameDecl(int level, Atom idprefix = Atom());
 
 	virtual void run() = 0;					///< Compile...
 };
@@ -0,0 +1,275 @@
+/********************************************************************************************//**
+ * @file cppemitter.cc
+ *
+ * class CppEmitter implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "cppemitter.h"
+
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+using namespace std;
+
+/************************************************************************************************
+ * class CppEmitter
+ ************************************************************************************************/
+
+// private static
+
+/********************************************************************************************//**
+ * Reals are written with enough digits to reproduce them exactly.
+ *
+ * @param	value	A constant
+ * @return	A C++ expression that constructs value
+ ************************************************************************************************/
+string CppEmitter::literal(const Datum& value) {
+	ostringstream oss;
+	switch(value.kind()) {
+	case Datum::Boolean:
+		oss << "Datum(" << (value.boolean() ? "true" : "false") << ")";
+		break;
+
+	case Datum::Character:
+		oss << "Datum(static_cast<char>(" << static_cast<int>(value.character()) << "))";
+		break;
+
+	case Datum::Integer:
+		oss << "Datum(static_cast<int>(" << value.integer() << "))";
+		break;
+
+	case Datum::Real:
+		if (isinf(value.real()))
+			oss << "Datum(" << (value.real() < 0 ? "-" : "") << "HUGE_VAL)";
+		else if (isnan(value.real()))
+			oss << "Datum(NAN)";
+		else
+			oss << "Datum(" << scientific << setprecision(16) << value.real() << ")";
+		break;
+	}
+
+	return oss.str();
+}
+
+// private
+
+/********************************************************************************************//**
+ * @param	b	A procedure's entry block
+ * @return	The procedure's name, from it's address
+ ************************************************************************************************/
+string CppEmitter::name(size_t b) const {
+	return "p" + to_string(cfg.blocks()[b].lines[0]);
+}
+
+/********************************************************************************************//**
+ * @param	b	A block
+ * @return	The block's label, from it's address
+ ************************************************************************************************/
+string CppEmitter::label(size_t b) const {
+	return "L" + to_string(cfg.blocks()[b].lines[0]);
+}
+
+/********************************************************************************************//**
+ * Operation codes are written by value, with their names as comments.
+ *
+ * @param	code	The program
+ ************************************************************************************************/
+void CppEmitter::table(const InstrVector& code) {
+	*out << "static const Instr code[] = {\n";
+	for (size_t pc = 0; pc < code.size(); ++pc) {
+		const Instr& instr = code[pc];
+		*out	<< "\tInstr(static_cast<OpCode>(" << ordinal(instr.op) << "), "
+				<< static_cast<int>(instr.level) << ", " << literal(instr.value) << "),"
+				<< "\t// " << pc << ": " << OpCodeInfo::info(instr.op).name() << "\n";
+	}
+	*out << "};\n";
+}
+
+/********************************************************************************************//**
+ * Blocks are written in order, each labeled if it's jumped to. Block numbers are written as the
+ * address of the block's first instruction.
+ *
+ * @param	entry	The procedure's entry block
+ * @return	false if the procedure jumps into another, or calls something other than an entry
+ ************************************************************************************************/
+bool CppEmitter::procedure(size_t entry) {
+	const CFG::BlockVec& blocks = cfg.blocks();
+
+	vector<size_t> mine;					// My blocks, in order
+	for (size_t b = 0; b < blocks.size(); ++b)
+		if (owner[b] == entry)
+			mine.push_back(b);
+
+	set<size_t> targets;					// Blocks that are jumped to
+	for (size_t i = 0; i < mine.size(); ++i) {
+		const CFG::Block& block = blocks[mine[i]];
+		for (const auto& instr : block.code)
+			if (CFG::isCall(instr.op)) {
+				if (owner[instr.value.natural()] != instr.value.natural())
+					return false;
+
+			} else if (CFG::isBranch(instr.op))
+				targets.insert(instr.value.natural());
+
+		if (block.next != CFG::none && (i + 1 == mine.size() || mine[i + 1] != block.next))
+			targets.insert(block.next);
+	}
+
+	for (auto t : targets)
+		if (owner[t] != entry)
+			return false;
+
+	ostringstream body;
+	for (size_t i = 0; i < mine.size(); ++i) {
+		const CFG::Block& block = blocks[mine[i]];
+		if (targets.count(mine[i]) != 0)
+			body << label(mine[i]) << ":\n";
+
+		for (size_t j = 0; j < block.code.size(); ++j) {
+			const Instr& instr = block.code[j];
+			const unsigned pc = block.lines[j];
+			const bool one = instr.value.kind() == Datum::Integer && instr.value.integer() == 1;
+			string op = OpCodeInfo::info(instr.op).name();
+			for (auto& c : op)
+				c = toupper(c);
+
+			body << "\t";
+			switch(instr.op) {
+			case OpCode::PUSH:
+				body << "m.push(" << pc << ");";
+				break;
+
+			case OpCode::PUSHVAR:
+				body << "m.pushvar(" << pc << ", " << static_cast<int>(instr.level) << ", "
+					 << instr.value.integer() << ");";
+				break;
+
+			case OpCode::EVAL:
+				body << (one ? "m.eval(" : "m.exec(") << pc << ");";
+				break;
+
+			case OpCode::ASSIGN:
+				body << (one ? "m.assign(" : "m.exec(") << pc << ");";
+				break;
+
+			case OpCode::ADD:
+			case OpCode::SUB:
+			case OpCode::MUL:
+			case OpCode::DIV:
+			case OpCode::REM:
+				body << "m.arith(" << pc << ", OpCode::" << op << ");";
+				break;
+
+			case OpCode::LT:
+			case OpCode::LTE:
+			case OpCode::EQU:
+			case OpCode::GTE:
+			case OpCode::GT:
+			case OpCode::NEQ:
+				if (j + 1 < block.code.size() && block.code[j + 1].op == OpCode::JNEQI) {
+					body << "if (m.jump(" << pc << ", OpCode::" << op << ")) goto "
+						 << label(block.code[++j].value.natural()) << ";";
+				} else
+					body << "m.compare(" << pc << ", OpCode::" << op << ");";
+				break;
+
+			case OpCode::JUMPI:
+				body << "goto " << label(instr.value.natural()) << ";";
+				break;
+
+			case OpCode::JNEQI:
+				body << "if (m.jneqi(" << pc << ")) goto " << label(instr.value.natural()) << ";";
+				break;
+
+			case OpCode::FORNEXT:
+				body << "if (m.fornext(" << pc << ", " << static_cast<int>(instr.level) << ")) goto "
+					 << label(instr.value.natural()) << ";";
+				break;
+
+			case OpCode::CALLI:
+				body << "m.exec(" << pc << ");\n\t" << name(instr.value.natural()) << "(m);";
+				break;
+
+			case OpCode::TCALLI:
+				body << "m.exec(" << pc << ");\n\treturn " << name(instr.value.natural()) << "(m);";
+				break;
+
+			case OpCode::RET:
+			case OpCode::RETF:
+			case OpCode::HALT:
+				body << "m.exec(" << pc << ");\n\treturn;";
+				break;
+
+			default:
+				body << "m.exec(" << pc << ");";
+			}
+			body << "\n";
+		}
+
+		if (block.next != CFG::none && (i + 1 == mine.size() || mine[i + 1] != block.next))
+			body << "\tgoto " << label(block.next) << ";\n";
+	}
+
+	*out	<< "\n/// The procedure at " << blocks[entry].lines[0] << "\n"
+			<< "void " << name(entry) << "(PRuntime& m) {\n"
+			<< body.str()
+			<< "}\n";
+
+	return true;
+}
+
+// public
+
+/********************************************************************************************//**
+ * Code that can't be represented as a CFG, e.g., uses computed addresses, can't be translated.
+ *
+ * @param	code	The program
+ * @param	source	The program's source file name
+ * @param	out		Where to write the C++ program
+ *
+ * @return	false if code couldn't be translated
+ ************************************************************************************************/
+bool CppEmitter::operator()(const InstrVector& code, const string& source, ostream& out) {
+	CFG::SourceIndex addrs(code.size());	// Track each instruction's address as it's line
+	for (size_t pc = 0; pc < code.size(); ++pc)
+		addrs[pc] = pc;
+
+	if (code.empty() || !cfg.build(code, addrs))
+		return false;
+
+	owner = cfg.procedures();
+	this->out = &out;
+
+	const CFG::BlockVec& blocks = cfg.blocks();
+	set<size_t> entries;					// The program, and each procedure
+	for (size_t b = 0; b < blocks.size(); ++b)
+		if (owner[b] == b)
+			entries.insert(b);
+
+	out	<< "// Translated from " << source << " by p --emit-cpp. Build with:\n"
+		<< "//   c++ -std=c++11 -O2 -I<p's source> <this file> <p's source>/libp.a\n\n"
+		<< "#include <cmath>\n\n"
+		<< "#include \"runtime.h\"\n\n";
+	table(code);
+
+	out << "\n";
+	for (auto e : entries)
+		out << "void " << name(e) << "(PRuntime& m);\n";
+
+	for (auto e : entries)
+		if (!procedure(e))
+			return false;
+
+	out	<< "\nint main() {\n"
+		<< "\tPRuntime machine(code, sizeof(code) / sizeof(code[0]));\n"
+		<< "\treturn static_cast<int>(machine(" << name(0) << "));\n"
+		<< "}\n";
+
+	return true;
+}
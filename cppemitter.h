@@ -0,0 +1,50 @@
+/********************************************************************************************//**
+ * @file cppemitter.h
+ *
+ * class CppEmitter, translates P machine code into a C++ program.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	CPPEMITTER_H
+#define	CPPEMITTER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cfg.h"
+
+/********************************************************************************************//**
+ * Ahead of time translator
+ *
+ * Writes a standalone C++ program, that runs on PRuntime, the machine's run time support, and
+ * links with libp.a. The program's code is written as a table, followed by one C++ function per
+ * procedure; jumps become gotos, calls become calls, and each instruction a call to PRuntime,
+ * which handles integers inline, and anything else via the machine's own instruction.
+ ************************************************************************************************/
+class CppEmitter {
+public:
+	/// Translate code, compiled from source, into a C++ program on out...
+	bool operator()(const InstrVector& code, const std::string& source, std::ostream& out);
+
+private:
+	CFG							cfg;		///< The program; block lines are addresses
+	std::vector<size_t>			owner;		///< Entry block of each block's procedure
+	std::ostream*				out;		///< Where to write the program
+
+	/// Return the C++ expression for value
+	static std::string literal(const Datum& value);
+
+	/// Return the name of the procedure entered at block b
+	std::string name(size_t b) const;
+
+	/// Return the label of block b
+	std::string label(size_t b) const;
+
+	void table(const InstrVector& code);	///< Write the code table...
+	bool procedure(size_t entry);			///< Write the procedure entered at block entry...
+};
+
+#endif
@@ -521,6 +521,25 @@ bool Datum::zero() const {
 	}
 }
 
+/********************************************************************************************//**
+ * Used by code that accesses Datums directly, i.e., the JIT. The value is a union; an Integer is
+ * it's first four bytes, a Boolean or Character it's first byte.
+ *
+ * @return the byte offset of a Datum's value
+ ************************************************************************************************/
+size_t Datum::valueOffset() {
+	static const Datum d;
+	return reinterpret_cast<const char*>(&d.i) - reinterpret_cast<const char*>(&d);
+}
+
+/********************************************************************************************//**
+ * @return the byte offset of a Datum's kind
+ ************************************************************************************************/
+size_t Datum::kindOffset() {
+	static const Datum d;
+	return reinterpret_cast<const char*>(&d.k) - reinterpret_cast<const char*>(&d);
+}
+
 // operators
 
 /********************************************************************************************//**
@@ -92,6 +92,9 @@ public:
 	bool ordinal() const;					///< Return true if value is ordinal...
 	bool zero() const;						///< Return true if value is equal to zero...
 
+	static size_t valueOffset();			///< Return the byte offset of my value...
+	static size_t kindOffset();				///< Return the byte offset of my kind...
+
 private:
 	union {
 		bool		b;						///< if k == Boolean
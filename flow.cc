@@ -0,0 +1,263 @@
+/********************************************************************************************//**
+ * @file flow.cc
+ *
+ * class DeadCode, class ThreadJumps, class MergeBlocks and class HotColdLayout implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "flow.h"
+
+#include <set>
+
+using namespace std;
+
+/************************************************************************************************
+ * class DeadCode
+ ************************************************************************************************/
+
+// public
+
+/********************************************************************************************//**
+ * A "push Boolean; jneqi" is either a jump, or nothing at all.
+ *
+ * @param	cfg	The graph to rewrite
+ * @return	The number of branches resolved, and blocks removed
+ ************************************************************************************************/
+unsigned DeadCode::operator()(CFG& cfg) {
+	CFG::BlockVec& blocks = cfg.blocks();
+	unsigned changes = 0;
+
+	for (auto& b : blocks) {					// Resolve branches on constants
+		const size_t n = b.code.size();
+		if (b.removed || n < 2 || b.code[n - 1].op != OpCode::JNEQI || b.code[n - 2].op != OpCode::PUSH
+				|| b.code[n - 2].value.kind() != Datum::Boolean)
+			continue;
+
+		const Instr jneqi = b.code[n - 1];
+		const unsigned line = b.lines[n - 1];
+		const bool taken = !b.code[n - 2].value.boolean();
+		b.code.resize(n - 2);
+		b.lines.resize(n - 2);
+		if (taken) {
+			b.code.push_back(Instr(OpCode::JUMPI, 0, jneqi.value));
+			b.lines.push_back(line);
+			b.next = CFG::none;
+		}
+		++changes;
+	}
+
+	vector<bool> reached(blocks.size(), false);	// Find the blocks reachable from the entry
+	vector<size_t> work;
+	if (!blocks.empty())
+		work.push_back(0);
+
+	while (!work.empty()) {
+		const size_t b = work.back();
+		work.pop_back();
+		if (reached[b])
+			continue;
+
+		reached[b] = true;
+		for (auto s : cfg.successors(b))
+			work.push_back(s);
+
+		for (const auto& instr : blocks[b].code)
+			if (CFG::isCall(instr.op))
+				work.push_back(instr.value.natural());
+	}
+
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		CFG::Block& b = blocks[i];
+		if (reached[i] || b.removed)
+			continue;
+
+		b.code.clear();
+		b.lines.clear();
+		b.next = CFG::none;
+		b.removed = true;
+		++changes;
+	}
+
+	return changes;
+}
+
+/************************************************************************************************
+ * class ThreadJumps
+ ************************************************************************************************/
+
+// private
+
+/********************************************************************************************//**
+ * @param	cfg	The graph
+ * @param	b	The original branch target
+ * @return	The first block, reached from b, that does something, or b if there's a cycle
+ ************************************************************************************************/
+size_t ThreadJumps::destination(const CFG& cfg, size_t b) const {
+	set<size_t> visited;
+	size_t dest = b;
+
+	for (;;) {
+		if (!visited.insert(dest).second)
+			return b;							// a cycle; leave it be
+
+		const CFG::Block& block = cfg.blocks()[dest];
+		if (block.code.empty() && block.next != CFG::none)
+			dest = block.next;
+
+		else if (block.code.size() == 1 && block.code[0].op == OpCode::JUMPI)
+			dest = block.code[0].value.natural();
+
+		else
+			return dest;
+	}
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	cfg	The graph to rewrite
+ * @return	The number of branches retargeted
+ ************************************************************************************************/
+unsigned ThreadJumps::operator()(CFG& cfg) {
+	unsigned changes = 0;
+
+	for (auto& block : cfg.blocks()) {
+		if (block.removed)
+			continue;
+
+		for (auto& instr : block.code) {
+			if (instr.op != OpCode::JUMPI && instr.op != OpCode::JNEQI && instr.op != OpCode::FORNEXT)
+				continue;
+
+			const size_t dest = destination(cfg, instr.value.natural());
+			if (dest != instr.value.natural()) {
+				instr.value = dest;
+				++changes;
+			}
+		}
+	}
+
+	return changes;
+}
+
+/************************************************************************************************
+ * class MergeBlocks
+ ************************************************************************************************/
+
+// public
+
+/********************************************************************************************//**
+ * Merging doesn't change the number of references to any surviving block; the merged block's
+ * only reference is consumed, and it's references become it's predecessor's.
+ *
+ * @param	cfg	The graph to rewrite
+ * @return	The number of blocks merged
+ ************************************************************************************************/
+unsigned MergeBlocks::operator()(CFG& cfg) {
+	CFG::BlockVec& blocks = cfg.blocks();
+	const vector<unsigned> refs = cfg.references();
+	unsigned changes = 0;
+
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		CFG::Block& b = blocks[i];
+		while (!b.removed) {
+			size_t succ = CFG::none;
+			bool jump = false;
+			if (!b.code.empty() && b.code.back().op == OpCode::JUMPI) {
+				succ = b.code.back().value.natural();
+				jump = true;
+
+			} else if (b.next != CFG::none && (b.code.empty() || !CFG::isBranch(b.code.back().op)
+					|| b.code.back().op == OpCode::CALLI))
+				succ = b.next;
+
+			if (succ == CFG::none || succ == 0 || succ == i || refs[succ] != 1)
+				break;
+
+			CFG::Block& s = blocks[succ];
+			if (jump) {
+				b.code.pop_back();
+				b.lines.pop_back();
+			}
+
+			b.code.insert(b.code.end(), s.code.begin(), s.code.end());
+			b.lines.insert(b.lines.end(), s.lines.begin(), s.lines.end());
+			b.next = s.next;
+
+			s.code.clear();
+			s.lines.clear();
+			s.next = CFG::none;
+			s.removed = true;
+			++changes;
+		}
+	}
+
+	return changes;
+}
+
+/************************************************************************************************
+ * class HotColdLayout
+ ************************************************************************************************/
+
+// private
+
+/********************************************************************************************//**
+ * @param	block	The block
+ * @return	true if none of block's source lines were reached
+ ************************************************************************************************/
+bool HotColdLayout::cold(const CFG::Block& block) const {
+	if (block.code.empty())
+		return false;
+
+	for (auto line : block.lines)
+		if (profile.line(line) != 0)
+			return false;
+
+	return true;
+}
+
+// public
+
+/********************************************************************************************//**
+ * Blocks are renumbered, so branches, and fall through, are redirected to the new numbers.
+ *
+ * @param	cfg	The graph to rewrite
+ * @return	The number of blocks moved
+ ************************************************************************************************/
+unsigned HotColdLayout::operator()(CFG& cfg) {
+	CFG::BlockVec& blocks = cfg.blocks();
+	vector<size_t> order, colds;				// The new order of the blocks, hot ones first
+	for (size_t i = 0; i < blocks.size(); ++i)
+		if (i > 0 && !blocks[i].removed && cold(blocks[i]))
+			colds.push_back(i);
+		else
+			order.push_back(i);
+	order.insert(order.end(), colds.begin(), colds.end());
+
+	vector<size_t> number(blocks.size());		// Each block's new number
+	unsigned changes = 0;
+	for (size_t i = 0; i < order.size(); ++i) {
+		number[order[i]] = i;
+		if (order[i] != i)
+			++changes;
+	}
+
+	if (0 == changes)
+		return 0;
+
+	CFG::BlockVec laid;
+	for (auto b : order) {
+		laid.push_back(move(blocks[b]));
+		for (auto& instr : laid.back().code)
+			if (CFG::isBranch(instr.op))
+				instr.value = number[instr.value.natural()];
+
+		if (laid.back().next != CFG::none)
+			laid.back().next = number[laid.back().next];
+	}
+
+	blocks.swap(laid);
+	return changes;
+}
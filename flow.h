@@ -0,0 +1,86 @@
+/********************************************************************************************//**
+ * @file flow.h
+ *
+ * Control flow passes; class DeadCode, class ThreadJumps, class MergeBlocks and class
+ * HotColdLayout.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	FLOW_H
+#define	FLOW_H
+
+#include "pass.h"
+#include "profile.h"
+
+/********************************************************************************************//**
+ * Remove unreachable code
+ *
+ * Resolves branches on constant conditions, e.g., "if false then", and then removes the blocks
+ * that can't be reached from the program entry, following jumps, fall through and calls. Code
+ * following a return, the untaken arms of constant branches, and subroutines that are never
+ * called, or whose every call was inlined, are removed.
+ ************************************************************************************************/
+class DeadCode : public Pass {
+public:
+	DeadCode() : Pass("dead-code") {}		///< Constructor
+
+	/// Remove the unreachable blocks of cfg...
+	unsigned operator()(CFG& cfg) override;
+};
+
+/********************************************************************************************//**
+ * Thread jumps to jumps
+ *
+ * Retargets JUMPI, JNEQI and FORNEXT instructions, that branch to an empty block, or a block
+ * that's just a JUMPI, to the final destination. Cycles are left as is.
+ ************************************************************************************************/
+class ThreadJumps : public Pass {
+public:
+	ThreadJumps() : Pass("thread-jumps") {}	///< Constructor
+
+	/// Thread the jumps in cfg...
+	unsigned operator()(CFG& cfg) override;
+
+private:
+	/// Return the final destination of a branch to block b...
+	size_t destination(const CFG& cfg, size_t b) const;
+};
+
+/********************************************************************************************//**
+ * Merge straight line blocks
+ *
+ * Appends a block to it's only predecessor, if that predecessor unconditionally jumps, or falls
+ * through, to it. The entry block, and call targets, are never merged away.
+ ************************************************************************************************/
+class MergeBlocks : public Pass {
+public:
+	MergeBlocks() : Pass("merge-blocks") {}	///< Constructor
+
+	/// Merge the blocks of cfg...
+	unsigned operator()(CFG& cfg) override;
+};
+
+/********************************************************************************************//**
+ * Move cold blocks out of the way
+ *
+ * Blocks whose source lines were never reached in a training run are laid out after the rest of
+ * the program, in their original order, so hot code is straight line, and dense. The entry block
+ * stays put.
+ ************************************************************************************************/
+class HotColdLayout : public Pass {
+public:
+	/// Constructor
+	HotColdLayout(const Profile& profile) : Pass("hot-cold-layout"), profile(profile) {}
+
+	/// Lay out the blocks of cfg...
+	unsigned operator()(CFG& cfg) override;
+
+private:
+	const Profile&	profile;				///< The training run
+
+	bool cold(const CFG::Block& block) const;	///< Was block never reached?
+};
+
+#endif
@@ -43,6 +43,7 @@ const OpCodeInfo::InfoMap OpCodeInfo::opInfoTbl {
 	{ OpCode::ODD,		OpCodeInfo{ "Odd",		1			} },
 	{ OpCode::PRED,		OpCodeInfo{ "pred",		1			} },
 	{ OpCode::SUCC,		OpCodeInfo{ "succ",		1			} },
+	{ OpCode::ORD,		OpCodeInfo{ "ord",		1			} },
 
 	{ OpCode::SIN,		OpCodeInfo{ "sin",		1			} },
 	{ OpCode::SQR,		OpCodeInfo{ "sqr",		1			} },
@@ -81,7 +82,7 @@ const OpCodeInfo::InfoMap OpCodeInfo::opInfoTbl {
 
 	{ OpCode::OR,		OpCodeInfo{ "or",		2			} },
 	{ OpCode::AND,		OpCodeInfo{ "and",		2			} },
-	{ OpCode::NOT,		OpCodeInfo{ "not",		2			} },
+	{ OpCode::NOT,		OpCodeInfo{ "not",		1			} },
 
 	// Push/pop
 
@@ -91,11 +92,17 @@ const OpCodeInfo::InfoMap OpCodeInfo::opInfoTbl {
 	{ OpCode::EVAL,		OpCodeInfo{ "eval",		1			} },
 	{ OpCode::ASSIGN,	OpCodeInfo{ "assign",	2			} },
 	{ OpCode::COPY,		OpCodeInfo{	"copy",		2			} },
+	{ OpCode::ADDTO,	OpCodeInfo{	"addto",	2			} },
+	{ OpCode::SUBTO,	OpCodeInfo{	"subto",	2			} },
+	{ OpCode::MULTO,	OpCodeInfo{	"multo",	2			} },
+	{ OpCode::DIVTO,	OpCodeInfo{	"divto",	2			} },
 
 	// Call/return/jump...
 
 	{ OpCode::CALL,		OpCodeInfo{ "call",		2			} },
 	{ OpCode::CALLI,	OpCodeInfo{ "calli",	0			} },
+	{ OpCode::SLIDE,	OpCodeInfo{ "slide",	0			} },	// Size isn't staticly know
+	{ OpCode::TCALLI,	OpCodeInfo{ "tcalli",	0			} },
 
 	{ OpCode::ENTER,	OpCodeInfo{ "enter",	0			} },	// Size isn't staticly know
 	{ OpCode::RET,		OpCodeInfo{ "ret",		FrameSize	} },
@@ -106,9 +113,14 @@ const OpCodeInfo::InfoMap OpCodeInfo::opInfoTbl {
 	{ OpCode::JNEQ,		OpCodeInfo{ "jneq",		1			} },
 	{ OpCode::JNEQI,	OpCodeInfo{ "jneqi",	0			} },
 
+	{ OpCode::FORINIT,	OpCodeInfo{ "forinit",	3			} },
+	{ OpCode::FORNEXT,	OpCodeInfo{ "fornext",	2			} },
+
 	{ OpCode::LLIMIT,	OpCodeInfo{ "llimit",	1			} },
 	{ OpCode::ULIMIT,	OpCodeInfo{ "ulimit",	1			} },
 
+	{ OpCode::COMPILE,	OpCodeInfo{ "compile",	0			} },
+
 	{ OpCode::HALT,		OpCodeInfo{ "halt",		0			} }
 };
 
@@ -155,6 +167,7 @@ unsigned disasm(ostream& out, unsigned loc, const Instr& instr, const string lab
 	case OpCode::GET:
 	case OpCode::LLIMIT:
 	case OpCode::ULIMIT:
+	case OpCode::COMPILE:
 	case OpCode::POP:
 	case OpCode::PRED:
 	case OpCode::PUSH:
@@ -168,6 +181,9 @@ unsigned disasm(ostream& out, unsigned loc, const Instr& instr, const string lab
 
 	case OpCode::PUSHVAR:
 	case OpCode::CALLI:
+	case OpCode::SLIDE:
+	case OpCode::TCALLI:
+	case OpCode::FORNEXT:
 		out << " "	<< level << ", " << instr.value;
 		break;
 
@@ -52,6 +52,7 @@ enum class OpCode : unsigned char {
 	ODD,		///< ODD - Is odd?; Push(IsOdd(pop()))
 	PRED,		///< PRED ,limit - Predecessor; push(pop() - 1); OutOfRange if TOS was <= limit
 	SUCC,		///< SUCC ,limit - Successor; push(pop() + 1); OutOfRange if TOS was >= limit
+	ORD,		///< ORD - Ordinal value; push(Ord(pop()))
 
 	SIN,		///< SIN  - Sine; push(Sin(pop()))
 	SQR,		///< SQR  - Square; push(stack[sp] * pop())
@@ -95,9 +96,15 @@ enum class OpCode : unsigned char {
 	EVAL,		///< EVAL ,n - Evaluate variable; variable address is TOS, variable size is n Datums
 	ASSIGN,		///< ASSIGN ,n - Assign stack(TOS-n,TOS) to stack[addr,addr+n), POP ,n
 	COPY,		///< COPY ,n - Copy Datums; dest=pop(); src=pop(); copy n Datums from src to dest
+	ADDTO,		///< ADDTO - Add to a variable; r = pop(); stack[pop()] += r
+	SUBTO,		///< SUBTO - Subtract from a variable; r = pop(); stack[pop()] -= r
+	MULTO,		///< MULTO - Multiply a variable; r = pop(); stack[pop()] *= r
+	DIVTO,		///< DIVTO - Divide a variable; r = pop(); stack[pop()] /= r
 
 	CALL,		///< Call TOS-1,TOS - Call a subroutine, pushing a new activation Frame
 	CALLI,		///< Call level, address - Call a subroutine, pushing a new activation frame
+	SLIDE,		///< SLIDE m, n - Replace the current frame's n parameters with the top m Datums; discard the rest
+	TCALLI,		///< TCALLI level, address - Tail call a subroutine, reusing the current activation frame
 
 	ENTER,		///< ENTER ,n - Allocate n locals on the stack
 	RET,		///< Return from procedure; unlink Frame
@@ -108,9 +115,14 @@ enum class OpCode : unsigned char {
 	JNEQ,		///< Jump if condition is false
 	JNEQI,		///< Jump if condition is false
 
+	FORINIT,	///< FORINIT - Initialize a for-loop iterator; first = pop(); stack[stack[sp-1]] = first
+	FORNEXT,	///< FORNEXT inc,addr - Step a for-loop; last = TOS, iterator address = TOS-1
+
 	LLIMIT,		///< Check array index; out-of-range error if TOS <  addr
 	ULIMIT,		///< Check array index; out-of-range error if TOS >  addr
 
+	COMPILE,	///< COMPILE ,n - Compile deferred subroutine n, and jump to it's entry
+
 	HALT		///< Halt the machine
 };
 
@@ -21,10 +21,24 @@ using namespace std::rel_ops;
 
 // private:
 
+/********************************************************************************************//**
+ * @param		addr	The instruction address; must be less than codeSize
+ * @param[out]	instr	The instruction at addr, decoded if the program is mapped
+ ************************************************************************************************/
+void PInterp::fetch(size_t addr, Instr& instr) const {
+	if (records != nullptr)
+		Bytecode::decode(records[addr], instr);
+	else
+		instr = code[addr];
+}
+
 /********************************************************************************************//**
  * Dump the current machine state
  ************************************************************************************************/
 void PInterp::dump() {
+	if (trace)
+		output.drain();				// the trace follows the program's output
+
 	if (trace && lastWrite.valid())	// dump the last write...
 		cout << "    "
 			 << setw(5)	<< lastWrite << ": "
@@ -69,7 +83,9 @@ void PInterp::dump() {
 		cout << ' ' << *it++;
 	cout << endl;
 
-	disasm(cout, pc, code[pc], "pc");
+	Instr next;
+	fetch(pc, next);
+	disasm(cout, pc, next, "pc");
 
 	cout << endl;
 }
@@ -164,6 +180,7 @@ PInterp::InstrPtr PInterp::instrTbl[] = {
 	&PInterp::ODD,
 	&PInterp::PRED,
 	&PInterp::SUCC,
+	&PInterp::ORD,
 	&PInterp::SIN,
 	&PInterp::SQR,
 	&PInterp::SQRT,
@@ -199,8 +216,14 @@ PInterp::InstrPtr PInterp::instrTbl[] = {
 	&PInterp::EVAL,
 	&PInterp::ASSIGN,
 	&PInterp::COPY,
+	&PInterp::ADDTO,
+	&PInterp::SUBTO,
+	&PInterp::MULTO,
+	&PInterp::DIVTO,
 	&PInterp::CALL,
 	&PInterp::CALLI,
+	&PInterp::SLIDE,
+	&PInterp::TCALLI,
 	&PInterp::ENTER,
 	&PInterp::RET,
 	&PInterp::RETF,
@@ -208,8 +231,11 @@ PInterp::InstrPtr PInterp::instrTbl[] = {
 	&PInterp::JUMPI,
 	&PInterp::JNEQ,
 	&PInterp::JNEQI,
+	&PInterp::FORINIT,
+	&PInterp::FORNEXT,
 	&PInterp::LLIMIT,
 	&PInterp::ULIMIT,
+	&PInterp::COMPILE,
 	&PInterp::HALT
 };
 
@@ -397,6 +423,21 @@ Result PInterp::ODD() {
 		return Result::badDataType;
 }
 
+/********************************************************************************************//**
+ * Replace the TOS character, or boolean, value with its integer ordinal value.
+ * @return	badDataType if TOS isn't an ordinal type.
+ ************************************************************************************************/
+Result PInterp::ORD() {
+	Datum& TOS = tos();
+
+	switch (TOS.kind()) {
+	case Datum::Boolean:	TOS = TOS.boolean() ? 1 : 0;				return Result::success;
+	case Datum::Character:	TOS = static_cast<int>(TOS.character());	return Result::success;
+	case Datum::Integer:												return Result::success;
+	default:															return Result::badDataType;
+	}
+}
+
 /********************************************************************************************//**
  * Replace the TOS integer value with its predicesor value
  * @return	badDataType if TOS isn't a numeric type, outOfRange if the operation would exceed
@@ -496,6 +537,7 @@ Result PInterp::SUCC() {
  ************************************************************************************************/
 Result PInterp::GET() {
 	Result r = Result::success;
+	output.drain();							// Prompts are written before reading
 
 	if (ir.value.kind() != Datum::Integer) {
 		std::cerr << "get value is not an integer!" << std::endl;
@@ -563,21 +605,45 @@ Result PInterp::put() {
 	} else
 		n = nValue.integer();
 
+	const Datum* values = stack.data() + sp + 1 - n;
+	if (r == Result::success && n > 1 && w <= 1
+			&& all_of(values, values + n, [](const Datum& d) { return d.kind() == Datum::Character; })) {
+		for (size_t i = 0; i < n; ++i)		// A string, without padding; write it as is
+			output.put(values[i].character());
+		pop(n);
+		return r;
+	}
+
 	for (unsigned i = 0; i < n && r == Result::success; ++i) {
-		const Datum& value = stack[sp+i+1-n];
+		const Datum& value = values[i];
 
 		if (n > 1 && i == 0 && value.kind() != Datum::Character)
-			cout << '[';					// prefix for non-character arrays
+			output.put('[');				// prefix for non-character arrays
+
+		/*
+		 * cout's format is left as the manipulators that once wrote these left it, as the trace
+		 * writes Datums with it.
+		 */
 
 		switch(value.kind()) {
-		case Datum::Boolean:	cout << boolalpha << value.boolean();					break;
-		case Datum::Character:	cout << setw(w) << value.character();					break;
-		case Datum::Integer:	cout << setw(w) << setprecision(p) << value.integer();	break;
+		case Datum::Boolean:
+			output.put(value.boolean());
+			cout.setf(ios::boolalpha);
+			break;
+
+		case Datum::Character:
+			output.put(value.character(), w);
+			break;
+
+		case Datum::Integer:
+			output.put(value.integer(), w);
+			cout.precision(p);
+			break;
+
 		case Datum::Real:
-			if (p == 0)
-				cout << setw(w) << scientific << setprecision(6) << value.real();
-			else
-				cout << setw(w) << fixed << setprecision(p) << value.real();
+			output.put(value.real(), w, p == 0 ? 6 : p, p != 0);
+			cout.setf(p == 0 ? ios::scientific : ios::fixed, ios::floatfield);
+			cout.precision(p == 0 ? 6 : p);
 			break;
 
 		default:
@@ -587,9 +653,9 @@ Result PInterp::put() {
 
 		// Seperator, post-fix for non-character arrays
 		if (n > 1 && i < n-1 && value.kind() != Datum::Character)
-			cout << ',';
+			output.put(',');
 		else if (n > 1 && i == n-1 && value.kind() != Datum::Character)
-			cout << ']';
+			output.put(']');
 	}
 	pop(n);
 
@@ -623,7 +689,7 @@ Result PInterp::PUT() {
  ************************************************************************************************/
 Result PInterp::PUTLN() {
 	const Result r = put();
-	cout << '\n';
+	output.put('\n');
 	return r;
 }
 
@@ -1239,6 +1305,120 @@ Result PInterp::COPY() {
 	return r;
 }
 
+/********************************************************************************************//**
+ * Read-modify-write instructions, e.g, ADDTO, update the variable whose address is TOS-1 with
+ * the value on the TOS, in place; the address and value are consumed.
+ *
+ * Stack layout before;
+ *
+ * stack  | contents
+ * ------ | -------------------------------
+ * sp-1   | dst - the variable's address
+ * ------ | -------------------------------
+ * sp     | value
+ *
+ * @return	The variable, or nullptr if dst is out of range
+ ************************************************************************************************/
+Datum* PInterp::updated() {
+	const size_t dst = stack[sp - 1].natural();
+	if (!rangeCheck(dst, dst + 1))
+		return nullptr;
+
+	lastWrite = dst;
+	return &stack[dst];
+}
+
+/********************************************************************************************//**
+ * Add the numeric TOS to the variable whose address is TOS-1
+ * @return	stackUnderflow if the address is out of range, badDataType if either operand isn't
+ *			numeric.
+ ************************************************************************************************/
+Result PInterp::ADDTO() {
+	Datum* lhs = updated();
+	const Datum& rhs = tos();
+	Result r = Result::success;
+
+	if (lhs == nullptr)
+		r = Result::stackUnderflow;
+	else if (!lhs->numeric() || !rhs.numeric())
+		r = Result::badDataType;
+	else
+		*lhs = *lhs + rhs;
+
+	pop(2);
+	return r;
+}
+
+/********************************************************************************************//**
+ * Subtract the numeric TOS from the variable whose address is TOS-1
+ * @return	stackUnderflow if the address is out of range, badDataType if either operand isn't
+ *			numeric.
+ ************************************************************************************************/
+Result PInterp::SUBTO() {
+	Datum* lhs = updated();
+	const Datum& rhs = tos();
+	Result r = Result::success;
+
+	if (lhs == nullptr)
+		r = Result::stackUnderflow;
+	else if (!lhs->numeric() || !rhs.numeric())
+		r = Result::badDataType;
+	else
+		*lhs = *lhs - rhs;
+
+	pop(2);
+	return r;
+}
+
+/********************************************************************************************//**
+ * Multiply the variable whose address is TOS-1 by the numeric TOS
+ * @return	stackUnderflow if the address is out of range, badDataType if either operand isn't
+ *			numeric.
+ ************************************************************************************************/
+Result PInterp::MULTO() {
+	Datum* lhs = updated();
+	const Datum& rhs = tos();
+	Result r = Result::success;
+
+	if (lhs == nullptr)
+		r = Result::stackUnderflow;
+	else if (!lhs->numeric() || !rhs.numeric())
+		r = Result::badDataType;
+	else
+		*lhs = *lhs * rhs;
+
+	pop(2);
+	return r;
+}
+
+/********************************************************************************************//**
+ * Divide the variable whose address is TOS-1 by the numeric TOS
+ * @return	dividyByZero if the divisor is zero, stackUnderflow if the address is out of range,
+ *			badDataType if either operand isn't numeric.
+ ************************************************************************************************/
+Result PInterp::DIVTO() {
+	Datum* lhs = updated();
+	const Datum& rhs = tos();
+	Result r = Result::success;
+
+	if (lhs == nullptr)
+		r = Result::stackUnderflow;
+
+	else if (!lhs->numeric() || !rhs.numeric()) {
+		cerr << "Attampt to divide with non-numbeic value\n";
+		r =  Result::badDataType;
+
+	} else if (rhs.zero()) {
+		cerr << "Attempt to divide by zero @ pc (" << prevPc << ")!\n";
+		r = Result::divideByZero;
+
+	} else
+		*lhs = *lhs / rhs;
+
+	pop(2);
+	return r;
+}
+
 /********************************************************************************************//**
  * Call a subroutine whose level is TOS-1 and whose entry point is TOS
  * @return	success.
@@ -1281,6 +1461,55 @@ Result PInterp::CALLI() {
 	push(0ul);						//	FrameRetVal
 
 	pc = ir.value.natural();
+	if (jit)
+		jit->count(pc);
+
+	return Result::success;
+}
+
+/********************************************************************************************//**
+ * Prepare for a tail call; replace the current frame's ir.value parameters with the ir.level
+ * Datums on the top of the stack, moving the frame to follow them, and discarding locals and
+ * temporaries. The frame keeps it's static link, old frame pointer, and return address.
+ *
+ * @return	success, or stackUnderflow if the arguments aren't above the frame
+ ************************************************************************************************/
+Result PInterp::SLIDE() {
+	const size_t m = ir.level;
+	const size_t n = ir.value.natural();
+	if (fp < n || sp < fp + FrameSize - 1 + m)
+		return Result::stackUnderflow;
+
+	const Datum base = stack[fp + FrameBase];
+	const Datum oldFp = stack[fp + FrameOldFp];
+	const Datum retAddr = stack[fp + FrameRetAddr];
+
+	const size_t args = sp - m + 1;			// Arguments are always above their destination
+	for (size_t i = 0; i < m; ++i)
+		stack[fp - n + i] = stack[args + i];
+
+	fp = fp - n + m;
+	stack[fp + FrameBase] = base;
+	stack[fp + FrameOldFp] = oldFp;
+	stack[fp + FrameRetAddr] = retAddr;
+	sp = fp + FrameSize - 1;
+
+	return Result::success;
+}
+
+/********************************************************************************************//**
+ * Tail call the subroutine whose level is ir.level and whose entry point is ir.value, reusing
+ * the current frame, as prepared by SLIDE. The callee returns directly to our caller.
+ *
+ * @return	success.
+ ************************************************************************************************/
+Result PInterp::TCALLI() {
+	stack[fp + FrameBase] = base(ir.level);
+	stack[fp + FrameRetVal] = 0ul;
+
+	pc = ir.value.natural();
+	if (jit)
+		jit->count(pc);
 
 	return Result::success;
 }
@@ -1336,6 +1565,9 @@ Result PInterp::JUMP() {
  ************************************************************************************************/
 Result PInterp::JUMPI() {
 	pc = ir.value.natural();
+	if (jit && pc <= prevPc)
+		jit->count(pc);
+
 	return Result::success;
 }
 
@@ -1372,6 +1604,61 @@ Result PInterp::JNEQI() {
 	return Result::success;
 }
 
+/********************************************************************************************//**
+ * Assign the TOS, the iterators first value, to the iterator whose address is TOS-2, leaving
+ * the address, and the iterators last value (TOS-1), on the stack for FORNEXT.
+ *
+ * @return	stackUnderflow if the stack underflowed, or the iterator address is invalid.
+ ************************************************************************************************/
+Result PInterp::FORINIT() {
+	if (sp < 2)
+		return Result::stackUnderflow;
+
+	const Datum first = pop();
+	const size_t addr = stack[sp - 1].natural();
+	if (!rangeCheck(addr, addr + 1))
+		return Result::stackUnderflow;
+
+	stack[addr] = first;
+	lastWrite = addr;
+
+	return Result::success;
+}
+
+/********************************************************************************************//**
+ * If the iterator, whose address is TOS-1, hasn't reached the last value, TOS, step the
+ * iterator by ir.level (1 or -1) and jump to the start of the loop body, ir.value. Otherwise,
+ * pop the address and last value off of the stack, and continue with the next instruction.
+ *
+ * @return	stackUnderflow if the stack underflowed, or the iterator address is invalid.
+ *			badDataType if either the iterator or the last value aren't numeric.
+ ************************************************************************************************/
+Result PInterp::FORNEXT() {
+	if (sp < 1)
+		return Result::stackUnderflow;
+
+	const Datum& last = stack[sp];
+	const size_t addr = stack[sp - 1].natural();
+	if (!rangeCheck(addr, addr + 1))
+		return Result::stackUnderflow;
+
+	Datum& value = stack[addr];
+	if (!value.numeric() || !last.numeric())
+		return Result::badDataType;
+
+	if (ir.level > 0 ? value < last : last < value) {
+		value += Datum(static_cast<int>(ir.level));
+		lastWrite = addr;
+		pc = ir.value.natural();
+		if (jit && pc <= prevPc)
+			jit->count(pc);
+
+	} else
+		pop(2);
+
+	return Result::success;
+}
+
 /********************************************************************************************//**
  * @note	The TOS is not consumed.
  * @return	BadDataType if TOS isn't an Integer or a Boolean, outOfRange if the check failed.
@@ -1414,6 +1701,24 @@ Result PInterp::ULIMIT() {
 		return TOS > ir.value ? Result::outOfRange : Result::success;
 }
 
+/********************************************************************************************//**
+ * Compile deferred subroutine ir.value, which appends it's code to the program, and then jump to
+ * it's entry. The call that reached the stub has already pushed the subroutine's frame.
+ *
+ * @return	Result::compileError if there's no loader, or the subroutine has errors
+ ************************************************************************************************/
+Result PInterp::COMPILE() {
+	size_t entry = 0;
+	output.drain();							// The loader may write verbose messages
+	if (loader == nullptr || program == nullptr || !loader->load(ir.value.natural(), entry))
+		return Result::compileError;
+
+	code = program->data();					// The program may have moved
+	codeSize = program->size();
+	pc = entry;
+	return Result::success;
+}
+
 /********************************************************************************************//**
  * @return	halted
  ************************************************************************************************/
@@ -1428,7 +1733,7 @@ Result PInterp::step() {
 	Result r = Result::success;
 
 	prevPc = pc++;							// Fetch the next instruction...
-	ir = code[prevPc];
+	fetch(prevPc, ir);
 	++ncycles;
 
 	if (sp < OpCodeInfo::info(ir.op).nElements()) {
@@ -1443,9 +1748,32 @@ Result PInterp::step() {
 	} else
 		r = (*this.*instrTbl[ordinal(ir.op)]) ();
 
+	if (prof) {
+		prof->count(prevPc);
+		if ((ir.op == OpCode::JNEQ || ir.op == OpCode::JNEQI || ir.op == OpCode::FORNEXT) && pc != prevPc + 1)
+			prof->taken(prevPc);
+	}
+
 	return r;
 }
 
+/********************************************************************************************//**
+ * Native code runs until it reaches an instruction it can't, or won't, execute, which the machine
+ * then executes. Calls to procedures that aren't compiled count towards their heat.
+ ************************************************************************************************/
+void PInterp::native() {
+	Jit::State state { stack.data(), sp, fp, pc, heap.addr(), 0 };
+	const Jit::Status status = jit->run(state);
+
+	sp = state.sp;
+	fp = state.fp;
+	pc = state.pc;
+	ncycles += state.cycles;
+
+	if (Jit::Called == status)
+		jit->count(pc);
+}
+
 /********************************************************************************************//**
  *  @return	Result::success, or ...
  ************************************************************************************************/
@@ -1459,8 +1787,11 @@ Result PInterp::run() {
 	Result status = Result::success;
 	try {
 		do {
-			if (pc >= code.size()) {
-				cerr << "pc (" << pc << ") is out of range: [0.." << code.size() << ")!\n";
+			if (jit && jit->entry(pc) != nullptr && sp <= heap.addr())
+				native();						// The machine always steps past where it exits
+
+			if (pc >= codeSize) {
+				cerr << "pc (" << pc << ") is out of range: [0.." << codeSize << ")!\n";
 				status = Result::badFetch;
 
 			} else {
@@ -1478,6 +1809,174 @@ Result PInterp::run() {
 	if (status != Result::success && status != Result::halted)
 		cerr << "runtime error @pc " << prevPc << ", sp: " << sp << ": " << status << endl;
 
+	output.drain();							// The output precedes anything written after the run
+	return status;
+}
+
+/************************************************************************************************
+ * The register machine...
+ ************************************************************************************************/
+
+/********************************************************************************************//**
+ * @param			o		The operand
+ * @param			ri		The instruction, holding any constant operand
+ * @param[out]		temp	Holds the operand if it's popped off of the stack
+ * @return	The operand's value
+ ************************************************************************************************/
+const Datum& PInterp::operand(const Operand& o, const RegInstr& ri, Datum& temp) {
+	switch(o.mode) {
+	case Operand::Frame:	return stack[(o.level == 0 ? fp : base(o.level)) + o.offset];
+	case Operand::Const:	return ri.instr.value;
+	default:				temp = pop();	return temp;
+	}
+}
+
+/********************************************************************************************//**
+ * @param	o		The destination operand; a frame slot, or the stack
+ * @param	value	The value to write
+ ************************************************************************************************/
+void PInterp::store(const Operand& o, const Datum& value) {
+	if (o.mode == Operand::Stack)
+		push(value);
+
+	else {
+		const size_t addr = (o.level == 0 ? fp : base(o.level)) + o.offset;
+		stack[addr] = value;
+		lastWrite = addr;
+	}
+}
+
+/********************************************************************************************//**
+ * Integer operands are evaluated in place. Anything else, including division by zero, is pushed
+ * and evaluated by the equivalent stack machine instruction, so that results, and errors, are
+ * the same as the stack machine's.
+ *
+ * @param		ri		A binary, or conditional jump, instruction
+ * @param[out]	result	The result
+ * @return	success, or the stack machine instruction's result
+ ************************************************************************************************/
+Result PInterp::evaluate(const RegInstr& ri, Datum& result) {
+	Datum rtemp, ltemp;
+	const Datum& rhs = operand(ri.rhs, ri, rtemp);	// Popped in the same order as the stack machine
+	const Datum& lhs = operand(ri.lhs, ri, ltemp);
+
+	if (lhs.kind() == Datum::Integer && rhs.kind() == Datum::Integer) {
+		const int a = lhs.integer();
+		const int b = rhs.integer();
+
+		switch(ri.op) {
+		case RegOp::ADD:	result = a + b;		return Result::success;
+		case RegOp::SUB:	result = a - b;		return Result::success;
+		case RegOp::MUL:	result = a * b;		return Result::success;
+
+		case RegOp::DIV:
+			if (b == 0) break;
+			result = a / b;
+			return Result::success;
+
+		case RegOp::REM:
+			if (b == 0) break;
+			result = a % b;
+			return Result::success;
+
+		case RegOp::LT:		case RegOp::JNLT:	result = a < b;		return Result::success;
+		case RegOp::LTE:	case RegOp::JNLTE:	result = a <= b;	return Result::success;
+		case RegOp::EQU:	case RegOp::JNEQU:	result = a == b;	return Result::success;
+		case RegOp::GTE:	case RegOp::JNGTE:	result = a >= b;	return Result::success;
+		case RegOp::GT:		case RegOp::JNGT:	result = a > b;		return Result::success;
+		case RegOp::NEQ:	case RegOp::JNNEQ:	result = a != b;	return Result::success;
+
+		default:
+			;
+		}
+	}
+
+	push(lhs);
+	push(rhs);
+	const Result r = (this->*instrTbl[ordinal(ri.instr.op)]) ();
+	result = pop();
+	return r;
+}
+
+/********************************************************************************************//**
+ * @param	ri	The instruction to execute
+ * @return Result::success or...
+ ************************************************************************************************/
+Result PInterp::rstep(const RegInstr& ri) {
+	Datum result;
+	Result r = Result::success;
+
+	switch(ri.op) {
+	case RegOp::STACK:
+		ir = ri.instr;
+		if (sp < ri.nElements) {
+			cerr << "Out of bounds stack access @ pc (" << prevPc << "), sp == " << sp << "!\n";
+			r = Result::stackUnderflow;
+
+		} else
+			r = (this->*instrTbl[ordinal(ir.op)]) ();
+		break;
+
+	case RegOp::MOVE:
+		store(ri.dst, operand(ri.lhs, ri, result));
+		break;
+
+	case RegOp::ADD:
+	case RegOp::SUB:
+	case RegOp::MUL:
+	case RegOp::DIV:
+	case RegOp::REM:
+	case RegOp::LT:
+	case RegOp::LTE:
+	case RegOp::EQU:
+	case RegOp::GTE:
+	case RegOp::GT:
+	case RegOp::NEQ:
+		r = evaluate(ri, result);
+		store(ri.dst, result);
+		break;
+
+	default:								// Conditional jumps
+		r = evaluate(ri, result);
+		if (Result::success == r && !result.boolean())
+			pc = ri.target;
+	}
+
+	return r;
+}
+
+/********************************************************************************************//**
+ * Errors are reported at the address of the stack machine instruction that failed, as the
+ * stack machine would.
+ *
+ *  @return	Result::success, or ...
+ ************************************************************************************************/
+Result PInterp::rrun() {
+	Result status = Result::success;
+	try {
+		do {
+			if (pc >= codeSize) {
+				cerr << "pc (" << pc << ") is out of range: [0.." << codeSize << ")!\n";
+				status = Result::badFetch;
+
+			} else {
+				const RegInstr& ri = rcode[pc++];
+				prevPc = ri.addr;
+				++ncycles;
+				status = rstep(ri);
+			}
+
+		} while (Result::success == status);
+
+	} catch (Result result) {
+		cerr << result << " @pc " << prevPc << ", sp: " << sp << endl;
+		status = result;
+	}
+
+	if (status != Result::success && status != Result::halted)
+		cerr << "runtime error @pc " << prevPc << ", sp: " << sp << ": " << status << endl;
+
+	output.drain();							// The output precedes anything written after the run
 	return status;
 }
 
@@ -1490,24 +1989,46 @@ Result PInterp::run() {
  * @param fstoreSz	Size of the free store, in Datums.
  ************************************************************************************************/
 PInterp::PInterp(unsigned stackSz, unsigned fstoreSz)
-	:	stackSize{stackSz},
+	:	program{nullptr},
+		code{nullptr},
+		records{nullptr},
+		rcode{nullptr},
+		codeSize{0},
+		stackSize{stackSz},
 		stack(stackSize + fstoreSz, Datum(-1)),
 		heap(stackSz, fstoreSz),
 		trace(false),
-		ncycles(0)
+		ncycles(0),
+		prof(nullptr),
+		loader(nullptr),
+		output(cout)
 {
 	reset();
 }
 
 /********************************************************************************************//**
+ * Tracing, profiling, or lazy compilation, runs without the JIT, as does code the JIT can't load.
+ *
  *	@param	prog	The program to run
  *	@param 	trce	True for trace/debugging messages
+ *	@param	hot		Compile procedures called, or looping, this many times, or never if zero
  * 
  *  @return	The number of machine cycles run
  ************************************************************************************************/
-Result PInterp::operator()(const InstrVector& prog, bool trce) {
+Result PInterp::operator()(const InstrVector& prog, bool trce, unsigned hot) {
 	trace = trce;
-	code = prog;
+	program = &prog;
+	code = prog.data();
+	records = nullptr;
+	rcode = nullptr;
+	codeSize = prog.size();
+
+	jit.reset(hot > 0 && !trace && !prof && !loader ? new Jit(hot) : nullptr);
+	if (jit && !jit->load(prog))
+		jit.reset();
+
+	if (prof)
+		prof->reset(codeSize);
 
 	reset();
 
@@ -1518,6 +2039,57 @@ Result PInterp::operator()(const InstrVector& prog, bool trce) {
 	return result;
 }
 
+/********************************************************************************************//**
+ * The program's instructions are decoded as they're fetched, rather than loaded.
+ *
+ *	@param	prog	The mapped program to run
+ *	@param 	trce	True for trace/debugging messages
+ * 
+ *  @return	The number of machine cycles run
+ ************************************************************************************************/
+Result PInterp::operator()(const Bytecode& prog, bool trce) {
+	trace = trce;
+	program = nullptr;
+	code = nullptr;
+	records = prog.records();
+	rcode = nullptr;
+	codeSize = prog.size();
+	jit.reset();
+
+	reset();
+
+	auto result = run();
+	if (Result::halted == result)
+		result = Result::success;			// halted is normal!
+
+	return result;
+}
+
+/********************************************************************************************//**
+ * The register machine doesn't support tracing.
+ *
+ *	@param	prog	The register machine program to run
+ * 
+ *  @return	The number of machine cycles run
+ ************************************************************************************************/
+Result PInterp::operator()(const RegInstrVector& prog) {
+	trace = false;
+	program = nullptr;
+	code = nullptr;
+	records = nullptr;
+	rcode = prog.data();
+	codeSize = prog.size();
+	jit.reset();
+
+	reset();
+
+	auto result = rrun();
+	if (Result::halted == result)
+		result = Result::success;			// halted is normal!
+
+	return result;
+}
+
 /********************************************************************************************//**
  ************************************************************************************************/
 void PInterp::reset() {
@@ -1538,3 +2110,10 @@ size_t PInterp::cycles() const {
 	return ncycles;
 }
 
+/********************************************************************************************//**
+ * @return number of procedures compiled to native code by the last run
+ ************************************************************************************************/
+unsigned PInterp::compiled() const {
+	return jit ? jit->compiled() : 0;
+}
+
@@ -12,10 +12,17 @@
 
 #include <iostream>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "bytecode.h"
 #include "freestore.h"
 #include "instr.h"
+#include "jit.h"
+#include "loader.h"
+#include "output.h"
+#include "profile.h"
+#include "reginstr.h"
 #include "results.h"
 
 /********************************************************************************************//**
@@ -42,9 +49,23 @@ public:
 	virtual ~PInterp() {}
 
 	/// Load a applicaton and start the pl/0 machine running...
-	Result operator()(const InstrVector& prog, bool t = false);
+	Result operator()(const InstrVector& prog, bool t = false, unsigned hot = 0);
+
+	/// Run a mapped applicaton, in place...
+	Result operator()(const Bytecode& prog, bool t = false);
+
+	/// Run a register machine applicaton...
+	Result operator()(const RegInstrVector& prog);
+
 	void reset();							///< Reset the machine back to it's initial state.
 	size_t cycles() const;					///< Return number of machine cycles run so far
+	unsigned compiled() const;				///< Return the number of procedures compiled to native code
+
+	/// Count each instruction executed, and each jump taken, into p, or stop counting if nullptr
+	void profile(Profile* p)				{	prof = p;	}
+
+	/// Compile deferred subroutines with l, or none if nullptr
+	void lazy(Loader* l)					{	loader = l;	}
 
 protected:
 	/// A DatumVector iterator
@@ -67,6 +88,7 @@ protected:
 
 	template <class T> Result get();		///< Read a value from standard input
 	Result put();							///< Process PUTx instructions
+	Datum* updated();						///< Return the variable updated by ADDTO...
 
 	// The instructions...
 
@@ -81,6 +103,7 @@ protected:
 	Result DUP(); 							///< Duplicate
 	Result LOG(); 							///< Natural logarithm
 	Result ODD();							///< Is an odd number?
+	Result ORD();							///< Ordinal value
 	Result PRED();							///< Predicesor
 	Result SIN();							///< Sine
 	Result SQR();							///< Square
@@ -118,8 +141,14 @@ protected:
 	Result EVAL();							///< Evaluate Datum(s)...
 	Result ASSIGN();						///< Assign N Datums...
 	Result COPY();							///< Copy N Datums...
+	Result ADDTO();							///< Add to a variable...
+	Result SUBTO();							///< Subtract from a variable...
+	Result MULTO();							///< Multiply a variable...
+	Result DIVTO();							///< Divide a variable...
 	Result CALL(); 							///< Call a subroutine...
 	Result CALLI();							///< Call a subroutine
+	Result SLIDE();							///< Replace the frame's parameters with arguments...
+	Result TCALLI();						///< Tail call a subroutine...
 	Result RET();							///< Return from procedure...
 	Result RETF();							///< Return from a function...
 	Result ENTER();							///< Enter sub-routine, allocate space for locals
@@ -127,14 +156,31 @@ protected:
 	Result JUMPI();							///< Jump
 	Result JNEQ();							///< Jump if condition is false
 	Result JNEQI();							///< Jump if condition is false
+	Result FORINIT();						///< Initialize a for-loop iterator
+	Result FORNEXT();						///< Step a for-loop iterator
 	Result LLIMIT();						///< Check lower limit
 	Result ULIMIT();						///< Check upper limit
+	Result COMPILE();						///< Compile a deferred subroutine...
 	Result HALT();							///< Stop the machine
 
 	Result step();							///< Single step the machine...
+	void native();							///< Run native code, until it exits...
 	Result run();							///< Run the machine...
 
-private:
+	// The register machine...
+
+	/// Return operand o of ri, popping it into temp if it's on the stack...
+	const Datum& operand(const Operand& o, const RegInstr& ri, Datum& temp);
+
+	/// Write value to operand o...
+	void store(const Operand& o, const Datum& value);
+
+	/// Evaluate ri's binary operation...
+	Result evaluate(const RegInstr& ri, Datum& result);
+
+	Result rstep(const RegInstr& ri);		///< Execute a register machine instruction...
+	Result rrun();							///< Run the register machine...
+
 	/// A Effective Address that maybe invalidated
 	class EAddr {
 		std::size_t	eaddr;					///< The effective address
@@ -156,7 +202,11 @@ private:
 		void invalidate() 					{	val = false;	}
 	};
 
-	InstrVector	code;						///< Code segment, indexed by pc
+	const InstrVector* program;				///< The program, if loaded, that the loader may extend
+	const Instr* code;						///< Code segment, indexed by pc, unless mapped...
+	const Bytecode::Record* records;		///< ...otherwise, the mapped code segment
+	const RegInstr* rcode;					///< ...otherwise, the register machine code segment
+	size_t		codeSize;					///< Number of instructions in the code segment
 	unsigned	stackSize;					///< The size of the stack segment, in Datums.
 	DatumVector	stack;						///< Data segment (stack + free-store), indexed by fp and sp
 	FreeStore	heap;						///< Dynamic memory heap
@@ -168,7 +218,13 @@ private:
 	EAddr		lastWrite;					///< Last write effective address (to stack[]), if valid
 	bool		trace;						///< Trace run if true
 	unsigned  	ncycles;					///< Number of machine cycles run since the last reset
+	std::unique_ptr<Jit> jit;				///< Compiles hot procedures, if enabled
+	Profile*	prof;						///< Execution counts, if profiling
+	Loader*		loader;						///< Compiles deferred subroutines, if any
+	Output		output;						///< Buffered standard output, written by PUT and PUTLN
 
+private:
+	void fetch(size_t addr, Instr& instr) const; ///< Fetch the instruction at addr...
 	void dump();
 };
 
@@ -0,0 +1,1127 @@
+/********************************************************************************************//**
+ * @file jit.cc
+ *
+ * class Jit implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "jit.h"
+
+#include <cstring>
+#include <limits>
+#include <map>
+
+#if defined(__x86_64__)
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+#if defined(__x86_64__)
+
+namespace {
+	/// x86-64 general purpose registers
+	enum Reg : uint8_t {
+		RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15,
+		NoReg = 0xff						///< No index register
+	};
+
+	/// x86-64 condition codes
+	enum class Cond : uint8_t {
+		O, NO, B, AE, E, NE, BE, A, S, NS, P, NP, L, GE, LE, G
+	};
+
+	/// Return the inverse of condition cc
+	Cond invert(Cond cc)					{	return static_cast<Cond>(static_cast<uint8_t>(cc) ^ 1);	}
+
+	/// A memory operand; base + (index << scale) + disp
+	struct Mem {
+		Reg			base;					///< Base register
+		Reg			index;					///< Index register, or NoReg
+		uint8_t		scale;					///< log2 of index's scale factor
+		int32_t		disp;					///< Displacement
+
+		/// Construct [base + disp]
+		Mem(Reg base, int32_t disp) : base{base}, index{NoReg}, scale{0}, disp{disp} {}
+
+		/// Construct [base + (index << scale) + disp]
+		Mem(Reg base, Reg index, int32_t disp, uint8_t scale = 0)
+			: base{base}, index{index}, scale{scale}, disp{disp} {}
+	};
+
+	// Register assignments
+
+	const Reg Stack		= RBX;				///< The data segment
+	const Reg Sp		= R12;				///< Top of stack, as a byte offset from Stack
+	const Reg Fp		= R13;				///< Frame pointer, as an index
+	const Reg Regs		= R14;				///< The Native registers
+	const Reg Table		= R15;				///< Native entry points
+	const Reg Cycles	= RBP;				///< Instructions run
+
+	/// Size of a Datum
+	const int32_t DatumSz = sizeof(Datum);
+
+	static_assert(sizeof(Datum::Kind) == 4, "the templates compare kinds as double words");
+}
+
+/************************************************************************************************
+ * class Jit::Assembler
+ ************************************************************************************************/
+
+/********************************************************************************************//**
+ * An x86-64 machine code buffer
+ *
+ * Just enough of the instruction set for the templates. Memory operands are always encoded with
+ * a 32-bit displacement.
+ ************************************************************************************************/
+class Jit::Assembler {
+public:
+	vector<uint8_t>		code;				///< The machine code
+
+	size_t size() const						{	return code.size();	}	///< Return the current offset
+
+	/// Patch the rel32 at offset at to jump to offset to
+	void patch(size_t at, size_t to) {
+		const int32_t rel = static_cast<int32_t>(to - (at + 4));
+		memcpy(&code[at], &rel, sizeof(rel));
+	}
+
+	void byte(uint8_t b)					{	code.push_back(b);	}	///< Emit a byte
+
+	/// Emit a little endian double word
+	void dword(uint32_t d) {
+		for (unsigned i = 0; i < 4; ++i)
+			byte(d >> 8 * i);
+	}
+
+	/// Emit a little endian quad word
+	void qword(uint64_t q) {
+		for (unsigned i = 0; i < 8; ++i)
+			byte(q >> 8 * i);
+	}
+
+	/// Emit opc, with reg and the memory operand m
+	void op(bool w, initializer_list<uint8_t> opc, unsigned reg, const Mem& m) {
+		const unsigned index = m.index == NoReg ? 0 : m.index;
+		rex(w, reg, index, m.base);
+		for (auto o : opc)
+			byte(o);
+
+		const bool sib = m.index != NoReg || (m.base & 7) == RSP;
+		byte(0x80 | (reg & 7) << 3 | (sib ? 4 : m.base & 7));
+		if (sib)
+			byte(m.scale << 6 | (m.index == NoReg ? 4 : index & 7) << 3 | (m.base & 7));
+		dword(m.disp);
+	}
+
+	/// Emit opc, with reg and the register rm
+	void op(bool w, initializer_list<uint8_t> opc, unsigned reg, Reg rm) {
+		rex(w, reg, 0, rm);
+		for (auto o : opc)
+			byte(o);
+		byte(0xc0 | (reg & 7) << 3 | (rm & 7));
+	}
+
+	void mov(Reg dst, const Mem& src)		{	op(true, {0x8b}, dst, src);	}	///< mov r64, m64
+	void mov(const Mem& dst, Reg src)		{	op(true, {0x89}, src, dst);	}	///< mov m64, r64
+	void mov(Reg dst, Reg src)				{	op(true, {0x8b}, dst, src);	}	///< mov r64, r64
+	void mov32(Reg dst, const Mem& src)		{	op(false, {0x8b}, dst, src);	}	///< mov r32, m32
+	void mov32(const Mem& dst, Reg src)		{	op(false, {0x89}, src, dst);	}	///< mov m32, r32
+	void mov8(const Mem& dst, Reg src)		{	op(false, {0x88}, src, dst);	}	///< mov m8, r8
+
+	/// mov m32, imm32
+	void mov32(const Mem& dst, uint32_t imm)	{	op(false, {0xc7}, 0, dst);	dword(imm);	}
+
+	/// mov m64, simm32
+	void mov(const Mem& dst, int32_t imm)	{	op(true, {0xc7}, 0, dst);	dword(imm);	}
+
+	/// mov r64, imm64
+	void mov(Reg dst, uint64_t imm) {
+		rex(true, 0, 0, dst);
+		byte(0xb8 + (dst & 7));
+		qword(imm);
+	}
+
+	/// mov r32, imm32
+	void mov32(Reg dst, uint32_t imm) {
+		rex(false, 0, 0, dst);
+		byte(0xb8 + (dst & 7));
+		dword(imm);
+	}
+
+	void lea(Reg dst, const Mem& src)		{	op(true, {0x8d}, dst, src);	}		///< lea r64, m
+
+	void add32(Reg dst, const Mem& src)		{	op(false, {0x03}, dst, src);	}	///< add r32, m32
+	void sub32(Reg dst, const Mem& src)		{	op(false, {0x2b}, dst, src);	}	///< sub r32, m32
+	void imul32(Reg dst, const Mem& src)	{	op(false, {0x0f, 0xaf}, dst, src);	} ///< imul r32, m32
+	void cmp32(Reg lhs, const Mem& rhs)		{	op(false, {0x3b}, lhs, rhs);	}	///< cmp r32, m32
+	void cmp(Reg lhs, const Mem& rhs)		{	op(true, {0x3b}, lhs, rhs);	}	///< cmp r64, m64
+	void cmp(Reg lhs, Reg rhs)				{	op(true, {0x3b}, lhs, rhs);	}	///< cmp r64, r64
+	void test32(Reg lhs, Reg rhs)			{	op(false, {0x85}, rhs, lhs);	}	///< test r32, r32
+	void test(Reg lhs, Reg rhs)				{	op(true, {0x85}, rhs, lhs);	}	///< test r64, r64
+	void xor32(Reg dst, Reg src)			{	op(false, {0x33}, dst, src);	}	///< xor r32, r32
+
+	/// cmp m32, imm32
+	void cmp32(const Mem& lhs, int32_t imm)	{	op(false, {0x81}, 7, lhs);	dword(imm);	}
+
+	/// cmp r32, imm32
+	void cmp32(Reg lhs, int32_t imm)		{	op(false, {0x81}, 7, lhs);	dword(imm);	}
+
+	/// cmp r64, simm32
+	void cmp(Reg lhs, int32_t imm)			{	op(true, {0x81}, 7, lhs);	dword(imm);	}
+
+	/// cmp m8, imm8
+	void cmp8(const Mem& lhs, uint8_t imm)	{	op(false, {0x80}, 7, lhs);	byte(imm);	}
+
+	/// imul r64, r64, imm32
+	void imul(Reg dst, Reg src, int32_t imm)	{	op(true, {0x69}, dst, src);	dword(imm);	}
+
+	void imul(Reg dst, Reg src)				{	op(true, {0x0f, 0xaf}, dst, src);	}	///< imul r64, r64
+
+	/// shr r64, imm8
+	void shr(Reg dst, uint8_t imm)			{	op(true, {0xc1}, 5, dst);	byte(imm);	}
+
+	void cdq()								{	byte(0x99);	}					///< edx:eax = eax
+	void idiv32(Reg divisor)				{	op(false, {0xf7}, 7, divisor);	}	///< idiv r32
+
+	/// setcc r8
+	void set(Cond cc, Reg dst)				{	op(false, {0x0f, uint8_t(0x90 + uint8_t(cc))}, 0, dst);	}
+
+	/// jcc rel32, returning the offset of rel32
+	size_t j(Cond cc) {
+		byte(0x0f);
+		byte(0x80 + static_cast<uint8_t>(cc));
+		dword(0);
+		return size() - 4;
+	}
+
+	/// jmp rel32, returning the offset of rel32
+	size_t jmp() {
+		byte(0xe9);
+		dword(0);
+		return size() - 4;
+	}
+
+	void jmp(Reg target)					{	op(false, {0xff}, 4, target);	}	///< jmp r64
+
+	/// push r64
+	void push(Reg r) {
+		rex(false, 0, 0, r);
+		byte(0x50 + (r & 7));
+	}
+
+	/// pop r64
+	void pop(Reg r) {
+		rex(false, 0, 0, r);
+		byte(0x58 + (r & 7));
+	}
+
+	void ret()								{	byte(0xc3);	}					///< ret
+
+private:
+	/// Emit a REX prefix, if it's needed
+	void rex(bool w, unsigned reg, unsigned index, unsigned base) {
+		const uint8_t prefix = 0x40 | (w ? 8 : 0) | (reg & 8) >> 1 | (index & 8) >> 2 | (base & 8) >> 3;
+		if (prefix != 0x40)
+			byte(prefix);
+	}
+};
+
+/************************************************************************************************
+ * class Jit::Procedure
+ ************************************************************************************************/
+
+/********************************************************************************************//**
+ * Compiles a procedure
+ *
+ * The buffer is laid out as the procedure's code, in block order, then the epilogue, and then
+ * the exit stubs. Each instruction's template checks the stack depth, the push limit, and it's
+ * operands kinds, exiting to the machine, before changing anything, if any check fails.
+ ************************************************************************************************/
+class Jit::Procedure {
+public:
+	/// Construct a compiler for the procedure entered at block entry
+	Procedure(Jit& jit, size_t entry) : jit{jit}, entry{entry} {}
+
+	/// Compile, and install, the procedure...
+	bool operator()(Buffer& buffer);
+
+private:
+	/// A jump to an instruction, or an exit
+	struct Fixup {
+		size_t		at;						///< Offset of the rel32
+		size_t		pc;						///< The target
+		int			status;					///< Exit with status, or -1 for a jump to pc
+	};
+
+	Jit&						jit;		///< The compiler
+	size_t						entry;		///< Entry block
+	Assembler					a;			///< The code
+	map<size_t, size_t>			labels;		///< Offset of each instruction, by pc
+	map<size_t, size_t>			entries;	///< Offset of each entry point, by pc
+	vector<Fixup>				fixups;		///< Jumps to resolve
+	vector<size_t>				dispatches;	///< Jumps to the dynamic exit
+	size_t						nInstrs;	///< Number of instructions in the program
+
+	static Mem slot(int n)					{	return Mem(Stack, Sp, n * DatumSz + Datum::valueOffset());	}
+	static Mem kind(int n)					{	return Mem(Stack, Sp, n * DatumSz + Datum::kindOffset());	}
+
+	/// Jump to pc, or exit to the machine with status, if cc
+	void exit(Cond cc, size_t pc, Status status = Continue) {
+		fixups.push_back(Fixup { a.j(cc), pc, status });
+	}
+
+	/// Jump to pc, or exit to the machine with status
+	void exit(size_t pc, Status status = Continue) {
+		fixups.push_back(Fixup { a.jmp(), pc, status });
+	}
+
+	/// Jump to the instruction at pc, or, if it isn't in this procedure, exit to it
+	void jump(Cond cc, size_t pc)			{	fixups.push_back(Fixup { a.j(cc), pc, -1 });	}
+	void jump(size_t pc)					{	fixups.push_back(Fixup { a.jmp(), pc, -1 });	}
+
+	/// Count n instructions run, without changing the flags
+	void count(unsigned n)					{	a.lea(Cycles, Mem(Cycles, n));	}
+
+	/// Exit to pc unless there are at least n Datums on the stack
+	void depth(size_t n, size_t pc) {
+		if (n > 0) {
+			a.cmp(Sp, static_cast<int32_t>(n * DatumSz));
+			exit(Cond::B, pc);
+		}
+	}
+
+	/// Exit to pc unless n Datums may be pushed; clobbers rax
+	void room(size_t n, size_t pc) {
+		a.lea(RAX, Mem(Sp, n * DatumSz));
+		a.cmp(RAX, Mem(Regs, offsetof(Native, limit)));
+		exit(Cond::A, pc);
+	}
+
+	/// Exit to pc unless the Datum at m's kind is k
+	void is(const Mem& m, Datum::Kind k, size_t pc) {
+		a.cmp32(m, k);
+		exit(Cond::NE, pc);
+	}
+
+	/// Set rax to base(level), exiting to pc if the static chain is invalid; clobbers rcx
+	void base(int8_t level, size_t pc) {
+		a.mov(RAX, Fp);
+		for (; level > 0; --level) {
+			a.imul(RCX, RAX, DatumSz);
+			is(Mem(Stack, RCX, Datum::kindOffset()), Datum::Integer, pc);
+			a.mov32(RAX, Mem(Stack, RCX, Datum::valueOffset()));
+			a.test32(RAX, RAX);
+			exit(Cond::S, pc);
+		}
+	}
+
+	/// Set rax to the variable address level, offset, exiting to pc if it isn't a valid Datum
+	void address(int8_t level, int offset, size_t pc) {
+		base(level, pc);
+		a.lea(RAX, Mem(RAX, offset));
+		a.cmp(RAX, numeric_limits<int>::max());
+		exit(Cond::A, pc);
+	}
+
+	/// Write Datum(int(r)) to m
+	void store(const Mem& m, Reg r) {
+		a.mov32(m, r);
+		a.mov32(Mem(m.base, m.index, m.disp - Datum::valueOffset() + Datum::kindOffset()),
+			static_cast<uint32_t>(Datum::Integer));
+	}
+
+	/// Copy the Datum at src to dst; clobbers rcx and rdx
+	void copy(const Mem& dst, const Mem& src) {
+		const int32_t k = Datum::kindOffset() - Datum::valueOffset();
+		a.mov(RCX, src);
+		a.mov32(RDX, Mem(src.base, src.index, src.disp + k));
+		a.mov(dst, RCX);
+		a.mov32(Mem(dst.base, dst.index, dst.disp + k), RDX);
+	}
+
+	/// Exit to pc if the jump target, in rdx, isn't compiled, otherwise jump to it
+	void dispatch() {
+		a.cmp(RDX, static_cast<int32_t>(nInstrs));
+		dispatches.push_back(a.j(Cond::AE));
+		a.mov(RAX, Mem(Table, RDX, 0, 3));
+		a.test(RAX, RAX);
+		dispatches.push_back(a.j(Cond::E));
+		a.jmp(RAX);
+	}
+
+	/// Compile instr, and it's successor, next, if they may be fused...
+	bool emit(const Instr& instr, size_t pc, const Instr* next);
+
+	bool binary(const Instr& instr, size_t pc, const Instr* next);	///< Compile a binary operation...
+	void update(const Instr& instr, size_t pc);						///< Compile ADDTO, SUBTO or MULTO
+	void push(const Datum& value, size_t pc);						///< Compile PUSH
+	void call(const Instr& instr, size_t pc);						///< Compile CALLI
+	void slide(const Instr& instr, size_t pc);						///< Compile SLIDE
+	void tcall(const Instr& instr, size_t pc);						///< Compile TCALLI
+	void enter(size_t target);										///< Jump to a procedure...
+	void ret(const Instr& instr, size_t pc, bool function);			///< Compile RET or RETF
+	void fornext(const Instr& instr, size_t pc);					///< Compile FORNEXT
+};
+
+/********************************************************************************************//**
+ * @param	value	The constant
+ * @param	pc		The instruction's address
+ ************************************************************************************************/
+void Jit::Procedure::push(const Datum& value, size_t pc) {
+	uint64_t bits = 0;						// The union, as the Datum constructors leave it
+	switch(value.kind()) {
+	case Datum::Boolean:	bits = value.boolean();						break;
+	case Datum::Character:	bits = static_cast<uint8_t>(value.character());	break;
+	case Datum::Integer:	bits = static_cast<uint32_t>(value.integer());	break;
+	case Datum::Real: {
+		const double r = value.real();
+		memcpy(&bits, &r, sizeof(bits));
+		break;
+	}
+	}
+
+	depth(OpCodeInfo::info(OpCode::PUSH).nElements(), pc);
+	room(1, pc);
+	count(1);
+	a.mov(RAX, bits);
+	a.mov(slot(1), RAX);
+	a.mov32(kind(1), static_cast<uint32_t>(value.kind()));
+	a.lea(Sp, Mem(Sp, DatumSz));
+}
+
+/********************************************************************************************//**
+ * Integer arithmetic and comparisons. A comparison followed by a JNEQI is fused into a single
+ * compare and branch.
+ *
+ * @param	instr	The instruction
+ * @param	pc		instr's address
+ * @param	next	The next instruction, if it may be fused, or nullptr
+ * @return	true if next was fused
+ ************************************************************************************************/
+bool Jit::Procedure::binary(const Instr& instr, size_t pc, const Instr* next) {
+	depth(2, pc);
+	is(kind(-1), Datum::Integer, pc);
+	is(kind(0), Datum::Integer, pc);
+
+	Cond cc;
+	switch(instr.op) {
+	case OpCode::ADD:
+	case OpCode::SUB:
+	case OpCode::MUL:
+		a.mov32(RAX, slot(-1));
+		if (instr.op == OpCode::ADD)		a.add32(RAX, slot(0));
+		else if (instr.op == OpCode::SUB)	a.sub32(RAX, slot(0));
+		else								a.imul32(RAX, slot(0));
+		count(1);
+		a.mov32(slot(-1), RAX);
+		a.lea(Sp, Mem(Sp, -DatumSz));
+		return false;
+
+	case OpCode::DIV:
+	case OpCode::REM:
+		a.mov32(RCX, slot(0));				// The machine reports division by zero, and traps
+		a.test32(RCX, RCX);					// on overflow
+		exit(Cond::E, pc);
+		a.cmp32(RCX, -1);
+		exit(Cond::E, pc);
+		a.mov32(RAX, slot(-1));
+		a.cdq();
+		a.idiv32(RCX);
+		count(1);
+		a.mov32(slot(-1), instr.op == OpCode::DIV ? RAX : RDX);
+		a.lea(Sp, Mem(Sp, -DatumSz));
+		return false;
+
+	case OpCode::LT:	cc = Cond::L;	break;
+	case OpCode::LTE:	cc = Cond::LE;	break;
+	case OpCode::EQU:	cc = Cond::E;	break;
+	case OpCode::GTE:	cc = Cond::GE;	break;
+	case OpCode::GT:	cc = Cond::G;	break;
+	default:			cc = Cond::NE;	break;
+	}
+
+	a.mov32(RAX, slot(-1));
+	a.cmp32(RAX, slot(0));
+	if (next != nullptr && next->op == OpCode::JNEQI) {
+		count(2);
+		a.lea(Sp, Mem(Sp, -2 * DatumSz));
+		jump(invert(cc), next->value.natural());
+		return true;
+	}
+
+	a.set(cc, RCX);
+	count(1);
+	a.lea(Sp, Mem(Sp, -DatumSz));
+	a.mov8(slot(0), RCX);
+	a.mov32(kind(0), static_cast<uint32_t>(Datum::Boolean));
+	return false;
+}
+
+/********************************************************************************************//**
+ * Integer read-modify-write of a variable on the stack.
+ *
+ * @param	instr	The instruction
+ * @param	pc		instr's address
+ ************************************************************************************************/
+void Jit::Procedure::update(const Instr& instr, size_t pc) {
+	depth(2, pc);
+	is(kind(0), Datum::Integer, pc);		// the value
+	is(kind(-1), Datum::Integer, pc);		// the variable's address
+	a.mov32(RAX, slot(-1));
+	a.test32(RAX, RAX);
+	exit(Cond::S, pc);
+	a.imul(RAX, RAX, DatumSz);
+	a.cmp(RAX, Sp);
+	exit(Cond::A, pc);
+	is(Mem(Stack, RAX, Datum::kindOffset()), Datum::Integer, pc);
+
+	count(1);
+	const Mem value(Stack, RAX, Datum::valueOffset());
+	a.mov32(RCX, value);
+	if (instr.op == OpCode::ADDTO)			a.add32(RCX, slot(0));
+	else if (instr.op == OpCode::SUBTO)		a.sub32(RCX, slot(0));
+	else									a.imul32(RCX, slot(0));
+	a.mov32(value, RCX);
+	a.lea(Sp, Mem(Sp, -2 * DatumSz));
+}
+
+/********************************************************************************************//**
+ * Pushes the frame, as CALLI does, and then jumps to the procedure if it's compiled; recursive
+ * calls jump directly.
+ *
+ * @param	instr	The instruction
+ * @param	pc		instr's address
+ ************************************************************************************************/
+void Jit::Procedure::call(const Instr& instr, size_t pc) {
+	const size_t target = instr.value.natural();
+
+	room(4, pc);
+	base(instr.level, pc);
+	count(1);
+	store(slot(1), RAX);					// FrameBase
+	store(slot(2), Fp);						// FrameOldFp
+	a.mov32(RAX, static_cast<uint32_t>(pc + 1));
+	store(slot(3), RAX);					// FrameRetAddr
+	a.xor32(RAX, RAX);
+	store(slot(4), RAX);					// FrameRetVal
+
+	a.lea(Fp, Mem(Sp, DatumSz));			// fp = sp + 1, as an index; (sp >> k) * (1/m),
+	unsigned shift = 0;						// where sizeof(Datum) == m << k, is exact
+	uint64_t m = DatumSz;
+	for (; (m & 1) == 0; m >>= 1)
+		++shift;
+	uint64_t inverse = m;					// Newton's method, mod 2^64
+	for (unsigned i = 0; i < 6; ++i)
+		inverse *= 2 - m * inverse;
+
+	if (shift > 0)
+		a.shr(Fp, shift);
+	if (m != 1) {
+		a.mov(RCX, inverse);
+		a.imul(Fp, RCX);
+	}
+	a.lea(Sp, Mem(Sp, 4 * DatumSz));
+	enter(target);
+}
+
+/********************************************************************************************//**
+ * Moves the arguments, and then the saved frame, down over the current frame, as SLIDE does.
+ *
+ * @param	instr	The instruction
+ * @param	pc		instr's address
+ ************************************************************************************************/
+void Jit::Procedure::slide(const Instr& instr, size_t pc) {
+	const int32_t m = instr.level;
+	const int32_t n = instr.value.integer();
+	const int32_t k = Datum::kindOffset() - Datum::valueOffset();
+
+	a.cmp(Fp, n);							// The new frame must be valid...
+	exit(Cond::B, pc);
+	a.imul(RAX, Fp, DatumSz);				// ...and, the arguments above the old one
+	a.lea(RCX, Mem(RAX, (FrameSize - 1 + m) * DatumSz));
+	a.cmp(RCX, Sp);
+	exit(Cond::A, pc);
+
+	count(1);
+	const Mem base(Stack, RAX, FrameBase * DatumSz + Datum::valueOffset());
+	const Mem oldFp(Stack, RAX, FrameOldFp * DatumSz + Datum::valueOffset());
+	const Mem retAddr(Stack, RAX, FrameRetAddr * DatumSz + Datum::valueOffset());
+	a.mov(R8, base);
+	a.mov32(R9, Mem(Stack, RAX, base.disp + k));
+	a.mov(R10, oldFp);
+	a.mov32(R11, Mem(Stack, RAX, oldFp.disp + k));
+	a.mov(RSI, retAddr);
+	a.mov32(RDI, Mem(Stack, RAX, retAddr.disp + k));
+
+	for (int32_t i = 0; i < m; ++i)			// The arguments are always above their destination
+		copy(Mem(Stack, RAX, (i - n) * DatumSz + Datum::valueOffset()), slot(i - m + 1));
+
+	a.lea(Fp, Mem(Fp, m - n));
+	a.lea(RAX, Mem(RAX, (m - n) * DatumSz));
+	a.mov(base, R8);
+	a.mov32(Mem(Stack, RAX, base.disp + k), R9);
+	a.mov(oldFp, R10);
+	a.mov32(Mem(Stack, RAX, oldFp.disp + k), R11);
+	a.mov(retAddr, RSI);
+	a.mov32(Mem(Stack, RAX, retAddr.disp + k), RDI);
+	a.lea(Sp, Mem(RAX, (FrameSize - 1) * DatumSz));
+}
+
+/********************************************************************************************//**
+ * Relinks the current frame, as TCALLI does, and then jumps to the procedure if it's compiled;
+ * recursive tail calls are loops.
+ *
+ * @param	instr	The instruction
+ * @param	pc		instr's address
+ ************************************************************************************************/
+void Jit::Procedure::tcall(const Instr& instr, size_t pc) {
+	a.imul(RCX, Fp, DatumSz);				// The frame must be on the stack
+	a.lea(RCX, Mem(RCX, (FrameSize - 1) * DatumSz));
+	a.cmp(RCX, Sp);
+	exit(Cond::A, pc);
+
+	base(instr.level, pc);
+	count(1);
+	a.imul(RCX, Fp, DatumSz);
+	store(Mem(Stack, RCX, FrameBase * DatumSz + Datum::valueOffset()), RAX);
+	a.xor32(RAX, RAX);
+	store(Mem(Stack, RCX, FrameRetVal * DatumSz + Datum::valueOffset()), RAX);
+	enter(instr.value.natural());
+}
+
+/********************************************************************************************//**
+ * Jump to the procedure at target, if it's compiled, otherwise exit to the machine, as called.
+ *
+ * @param	target	The procedure's entry point
+ ************************************************************************************************/
+void Jit::Procedure::enter(size_t target) {
+	if (jit.procOf[target] == entry)
+		jump(target);
+
+	else {
+		a.mov(RAX, Mem(Table, target * sizeof(void*)));
+		a.test(RAX, RAX);
+		exit(Cond::E, target, Called);
+		a.jmp(RAX);
+	}
+}
+
+/********************************************************************************************//**
+ * Unlinks the frame, as RET does, and then returns to the caller if it's compiled.
+ *
+ * @param	instr		The instruction
+ * @param	pc			instr's address
+ * @param	function	Push the function result, as RETF does?
+ ************************************************************************************************/
+void Jit::Procedure::ret(const Instr& instr, size_t pc, bool function) {
+	const int32_t n = instr.value.integer();
+
+	depth(FrameSize, pc);
+	a.cmp(Fp, n + 1);						// The new sp must be valid...
+	exit(Cond::B, pc);
+	a.imul(RAX, Fp, DatumSz);				// ...and, below the old sp
+	a.cmp(RAX, Sp);
+	exit(Cond::A, pc);
+
+	const Mem oldFp(Stack, RAX, FrameOldFp * DatumSz + Datum::valueOffset());
+	const Mem retAddr(Stack, RAX, FrameRetAddr * DatumSz + Datum::valueOffset());
+	is(Mem(Stack, RAX, FrameOldFp * DatumSz + Datum::kindOffset()), Datum::Integer, pc);
+	is(Mem(Stack, RAX, FrameRetAddr * DatumSz + Datum::kindOffset()), Datum::Integer, pc);
+	a.mov32(RDX, retAddr);
+	a.test32(RDX, RDX);
+	exit(Cond::S, pc);
+	a.mov32(RCX, oldFp);
+	a.test32(RCX, RCX);
+	exit(Cond::S, pc);
+
+	count(1);
+	if (function) {
+		const int32_t k = Datum::kindOffset() - Datum::valueOffset();
+		const Mem retVal(Stack, RAX, FrameRetVal * DatumSz + Datum::valueOffset());
+		a.mov(R8, retVal);
+		a.mov32(R9, Mem(Stack, RAX, retVal.disp + k));
+		a.lea(Sp, Mem(RAX, -n * DatumSz));
+		a.mov(slot(0), R8);
+		a.mov32(kind(0), R9);
+
+	} else
+		a.lea(Sp, Mem(RAX, -(n + 1) * DatumSz));
+
+	a.mov(Fp, RCX);
+	dispatch();
+}
+
+/********************************************************************************************//**
+ * @param	instr	The instruction
+ * @param	pc		instr's address
+ ************************************************************************************************/
+void Jit::Procedure::fornext(const Instr& instr, size_t pc) {
+	depth(2, pc);
+	is(kind(0), Datum::Integer, pc);		// last
+	is(kind(-1), Datum::Integer, pc);		// the iterator's address
+	a.mov32(RAX, slot(-1));
+	a.test32(RAX, RAX);
+	exit(Cond::S, pc);
+	a.imul(RAX, RAX, DatumSz);
+	a.cmp(RAX, Sp);
+	exit(Cond::A, pc);
+	is(Mem(Stack, RAX, Datum::kindOffset()), Datum::Integer, pc);
+
+	count(1);
+	const Mem value(Stack, RAX, Datum::valueOffset());
+	a.mov32(RCX, value);
+	a.cmp32(RCX, slot(0));
+	const size_t done = a.j(instr.level > 0 ? Cond::GE : Cond::LE);
+	a.lea(RCX, Mem(RCX, instr.level));
+	a.mov32(value, RCX);
+	jump(instr.value.natural());
+
+	a.patch(done, a.size());
+	a.lea(Sp, Mem(Sp, -2 * DatumSz));
+}
+
+/********************************************************************************************//**
+ * A PUSHVAR followed by an EVAL of one Datum is fused into a single load.
+ *
+ * @param	instr	The instruction
+ * @param	pc		instr's address
+ * @param	next	The next instruction, if it may be fused, or nullptr
+ * @return	true if next was fused
+ ************************************************************************************************/
+bool Jit::Procedure::emit(const Instr& instr, size_t pc, const Instr* next) {
+	const size_t nElements = OpCodeInfo::info(instr.op).nElements();
+	const bool one = instr.value.kind() == Datum::Integer && instr.value.integer() == 1;
+	bool fused = false;
+
+	switch(instr.op) {
+	case OpCode::PUSH:
+		push(instr.value, pc);
+		break;
+
+	case OpCode::PUSHVAR:
+		depth(nElements, pc);
+		room(1, pc);
+		address(instr.level, instr.value.integer(), pc);
+		if (next != nullptr && next->op == OpCode::EVAL && next->value.kind() == Datum::Integer
+				&& next->value.integer() == 1) {
+			a.imul(RAX, RAX, DatumSz);		// The variable must be on the stack
+			a.cmp(RAX, Sp);
+			exit(Cond::A, pc);
+			count(2);
+			copy(slot(1), Mem(Stack, RAX, Datum::valueOffset()));
+			a.lea(Sp, Mem(Sp, DatumSz));
+			fused = true;
+			break;
+		}
+
+		count(1);
+		store(slot(1), RAX);
+		a.lea(Sp, Mem(Sp, DatumSz));
+		break;
+
+	case OpCode::EVAL:
+		if (!one) {
+			exit(pc);
+			return false;
+		}
+
+		depth(nElements, pc);
+		is(kind(0), Datum::Integer, pc);
+		a.mov32(RAX, slot(0));
+		a.test32(RAX, RAX);
+		exit(Cond::S, pc);
+		a.imul(RAX, RAX, DatumSz);
+		a.cmp(RAX, Sp);
+		exit(Cond::AE, pc);
+		count(1);
+		copy(slot(0), Mem(Stack, RAX, Datum::valueOffset()));
+		break;
+
+	case OpCode::ASSIGN:
+		if (!one) {
+			exit(pc);
+			return false;
+		}
+
+		depth(nElements, pc);
+		is(kind(-1), Datum::Integer, pc);
+		a.mov32(RAX, slot(-1));
+		a.test32(RAX, RAX);
+		exit(Cond::S, pc);
+		a.imul(RAX, RAX, DatumSz);
+		a.cmp(RAX, Sp);
+		exit(Cond::A, pc);
+		count(1);
+		copy(Mem(Stack, RAX, Datum::valueOffset()), slot(0));
+		a.lea(Sp, Mem(Sp, -2 * DatumSz));
+		break;
+
+	case OpCode::ADD:
+	case OpCode::SUB:
+	case OpCode::MUL:
+	case OpCode::DIV:
+	case OpCode::REM:
+	case OpCode::LT:
+	case OpCode::LTE:
+	case OpCode::EQU:
+	case OpCode::GTE:
+	case OpCode::GT:
+	case OpCode::NEQ:
+		fused = binary(instr, pc, next);
+		break;
+
+	case OpCode::ADDTO:
+	case OpCode::SUBTO:
+	case OpCode::MULTO:
+		update(instr, pc);
+		break;
+
+	case OpCode::POP:
+		if (instr.value.kind() != Datum::Integer || instr.value.integer() < 0) {
+			exit(pc);
+			return false;
+		}
+
+		depth(max<size_t>(nElements, instr.value.integer()), pc);
+		count(1);
+		a.lea(Sp, Mem(Sp, -instr.value.integer() * DatumSz));
+		break;
+
+	case OpCode::DUP:
+		depth(nElements, pc);
+		room(1, pc);
+		count(1);
+		copy(slot(1), slot(0));
+		a.lea(Sp, Mem(Sp, DatumSz));
+		break;
+
+	case OpCode::ENTER:
+		if (instr.value.kind() != Datum::Integer || instr.value.integer() < 0) {
+			exit(pc);
+			return false;
+		}
+
+		room(instr.value.integer(), pc);
+		count(1);
+		a.mov(Sp, RAX);
+		break;
+
+	case OpCode::LLIMIT:
+	case OpCode::ULIMIT:
+		if (instr.value.kind() != Datum::Integer) {
+			exit(pc);
+			return false;
+		}
+
+		depth(nElements, pc);
+		is(kind(0), Datum::Integer, pc);
+		a.cmp32(slot(0), instr.value.integer());
+		exit(instr.op == OpCode::LLIMIT ? Cond::L : Cond::G, pc);
+		count(1);
+		break;
+
+	case OpCode::JUMPI:
+		count(1);
+		jump(instr.value.natural());
+		break;
+
+	case OpCode::JNEQI:
+		depth(max<size_t>(nElements, 1), pc);
+		is(kind(0), Datum::Boolean, pc);
+		count(1);
+		a.cmp8(slot(0), 0);
+		a.lea(Sp, Mem(Sp, -DatumSz));
+		jump(Cond::E, instr.value.natural());
+		break;
+
+	case OpCode::FORNEXT:
+		fornext(instr, pc);
+		break;
+
+	case OpCode::CALLI:
+		call(instr, pc);
+		break;
+
+	case OpCode::SLIDE:
+		if (instr.value.kind() != Datum::Integer || instr.value.integer() < 0 || instr.level < 0) {
+			exit(pc);
+			return false;
+		}
+
+		slide(instr, pc);
+		break;
+
+	case OpCode::TCALLI:
+		tcall(instr, pc);
+		break;
+
+	case OpCode::RET:
+	case OpCode::RETF:
+		if (instr.value.kind() != Datum::Integer || instr.value.integer() < 0) {
+			exit(pc);
+			return false;
+		}
+
+		ret(instr, pc, instr.op == OpCode::RETF);
+		break;
+
+	default:								// Let the machine run it
+		exit(pc);
+		return false;
+	}
+
+	entries[pc] = labels[pc];
+	return fused;
+}
+
+/********************************************************************************************//**
+ * @param[out]	buffer	The executable buffer
+ * @return	false if the procedure couldn't be installed
+ ************************************************************************************************/
+bool Jit::Procedure::operator()(Buffer& buffer) {
+	const CFG::BlockVec& blocks = jit.cfg.blocks();
+	nInstrs = jit.procOf.size();
+
+	size_t prev = CFG::none;				// The previous block emitted
+	for (size_t b = 0; b < blocks.size(); ++b) {
+		if (jit.owner[b] != entry)
+			continue;
+
+		if (prev != CFG::none && blocks[prev].next != CFG::none && blocks[prev].next != b)
+			jump(blocks[blocks[prev].next].lines[0]);	// Fall through to a block laid out elsewhere
+
+		InstrVector code = blocks[b].code;	// Relocate block numbers to addresses
+		for (auto& instr : code)
+			if (CFG::isBranch(instr.op))
+				instr.value = blocks[instr.value.natural()].lines[0];
+
+		for (size_t i = 0; i < code.size(); ++i) {
+			const size_t pc = blocks[b].lines[i];
+			labels[pc] = a.size();
+
+			const Instr* next = i + 1 < code.size() ? &code[i + 1] : nullptr;
+			if (emit(code[i], pc, next))
+				++i;
+		}
+		prev = b;
+	}
+
+	if (prev != CFG::none && blocks[prev].next != CFG::none)
+		jump(blocks[blocks[prev].next].lines[0]);
+
+	const size_t epilogue = a.size();		// Save the registers, and return status in eax
+	a.mov(Mem(Regs, offsetof(Native, sp)), Sp);
+	a.mov(Mem(Regs, offsetof(Native, fp)), Fp);
+	a.mov(Mem(Regs, offsetof(Native, cycles)), Cycles);
+	for (Reg r : { R15, R14, R13, R12, RBX, RBP })
+		a.pop(r);
+	a.ret();
+
+	const size_t dynamic = a.size();		// Exit to the pc in rdx
+	a.mov(Mem(Regs, offsetof(Native, pc)), RDX);
+	a.xor32(RAX, RAX);
+	a.patch(a.jmp(), epilogue);
+	for (auto at : dispatches)
+		a.patch(at, dynamic);
+
+	map<pair<size_t, int>, size_t> stubs;	// Exit stubs, by pc and status
+	for (const auto& f : fixups) {
+		const auto label = labels.find(f.pc);
+		if (f.status < 0 && label != labels.end()) {
+			a.patch(f.at, label->second);
+			continue;
+		}
+
+		const int status = f.status < 0 ? Continue : f.status;
+		auto stub = stubs.find(make_pair(f.pc, status));
+		if (stub == stubs.end()) {
+			stub = stubs.insert(make_pair(make_pair(f.pc, status), a.size())).first;
+			a.mov(Mem(Regs, offsetof(Native, pc)), static_cast<int32_t>(f.pc));
+			a.mov32(RAX, static_cast<uint32_t>(status));
+			a.patch(a.jmp(), epilogue);
+		}
+		a.patch(f.at, stub->second);
+	}
+
+	if (!jit.install(a.code, buffer))
+		return false;
+
+	for (const auto& e : entries)
+		jit.table[e.first] = static_cast<const uint8_t*>(buffer.base) + e.second;
+
+	return true;
+}
+
+#endif
+
+/************************************************************************************************
+ * class Jit
+ ************************************************************************************************/
+
+// private
+
+/********************************************************************************************//**
+ * @param		code	The machine code
+ * @param[out]	buffer	The executable buffer
+ * @return	false if the buffer couldn't be mapped
+ ************************************************************************************************/
+bool Jit::install(const vector<uint8_t>& code, Buffer& buffer) {
+#if defined(__x86_64__)
+	buffer.length = code.size();
+	buffer.base = mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (buffer.base == MAP_FAILED) {
+		buffer.base = nullptr;
+		return false;
+	}
+
+	memcpy(buffer.base, code.data(), code.size());
+	if (mprotect(buffer.base, buffer.length, PROT_READ | PROT_EXEC) != 0) {
+		munmap(buffer.base, buffer.length);
+		buffer.base = nullptr;
+		return false;
+	}
+
+	return true;
+#else
+	(void) code;
+	(void) buffer;
+	return false;
+#endif
+}
+
+/********************************************************************************************//**
+ * The stub is called as Status stub(Native* regs, const void* entry); it saves the callee saved
+ * registers, loads the machine's, and jumps to entry. Each procedure has it's own epilogue, that
+ * undoes the stub.
+ *
+ * @return	false if the stub couldn't be installed
+ ************************************************************************************************/
+bool Jit::prologue() {
+#if defined(__x86_64__)
+	Assembler a;
+	for (Reg r : { RBP, RBX, R12, R13, R14, R15 })
+		a.push(r);
+
+	a.mov(Regs, RDI);
+	a.mov(Stack, Mem(Regs, offsetof(Native, stack)));
+	a.mov(Sp, Mem(Regs, offsetof(Native, sp)));
+	a.mov(Fp, Mem(Regs, offsetof(Native, fp)));
+	a.mov(Table, Mem(Regs, offsetof(Native, table)));
+	a.xor32(Cycles, Cycles);
+	a.jmp(RSI);
+
+	return install(a.code, stub);
+#else
+	return false;
+#endif
+}
+
+/********************************************************************************************//**
+ * Procedures that can't be installed are left to the machine.
+ *
+ * @param	entry	The procedure's entry block
+ ************************************************************************************************/
+void Jit::compile(size_t entry) {
+#if defined(__x86_64__)
+	Buffer buffer { nullptr, 0 };
+	Procedure procedure(*this, entry);
+	if (procedure(buffer)) {
+		buffers.push_back(buffer);
+		++nCompiled;
+	}
+#else
+	(void) entry;
+#endif
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	hot		Compile a procedure once it's called, or jumps backwards, this many times
+ ************************************************************************************************/
+Jit::Jit(unsigned hot) : hot{hot}, nCompiled{0}, stub{nullptr, 0} {
+}
+
+/********************************************************************************************//**
+ ************************************************************************************************/
+Jit::~Jit() {
+#if defined(__x86_64__)
+	for (auto& b : buffers)
+		munmap(b.base, b.length);
+
+	if (stub.base != nullptr)
+		munmap(stub.base, stub.length);
+#endif
+}
+
+/********************************************************************************************//**
+ * Code that can't be represented as a CFG, e.g., uses computed addresses, can't be compiled.
+ *
+ * @param	code	The program
+ * @return	false if code can't be compiled
+ ************************************************************************************************/
+bool Jit::load(const InstrVector& code) {
+	CFG::SourceIndex addrs(code.size());	// Track each instruction's address as it's line
+	for (size_t pc = 0; pc < code.size(); ++pc)
+		addrs[pc] = pc;
+
+	if (code.empty() || !cfg.build(code, addrs))
+		return false;
+
+	const CFG::BlockVec& blocks = cfg.blocks();
+	owner = cfg.procedures();
+
+	procOf.assign(code.size(), CFG::none);
+	for (size_t b = 0; b < blocks.size(); ++b)
+		for (auto pc : blocks[b].lines)
+			procOf[pc] = owner[b];
+
+	heat.assign(blocks.size(), 0);
+	table.assign(code.size(), nullptr);
+
+	return prologue();
+}
+
+/********************************************************************************************//**
+ * Compiles addr's procedure once it's hot; each procedure is compiled at most once.
+ *
+ * @param	addr	The address called, or jumped to
+ ************************************************************************************************/
+void Jit::count(size_t addr) {
+	if (addr >= procOf.size() || procOf[addr] == CFG::none)
+		return;
+
+	const size_t proc = procOf[addr];
+	if (heat[proc] < hot && ++heat[proc] == hot)
+		compile(proc);
+}
+
+/********************************************************************************************//**
+ * @param	state	The machine's registers; updated when native code exits
+ * @return	Why native code exited
+ ************************************************************************************************/
+Jit::Status Jit::run(State& state) {
+	Native regs {
+		state.stack,
+		state.sp * sizeof(Datum),
+		state.fp,
+		state.pc,
+		table.data(),
+		state.limit * sizeof(Datum),
+		0
+	};
+
+	typedef Status (*Stub)(Native*, const void*);
+	const Stub native = reinterpret_cast<Stub>(stub.base);
+	const Status status = native(&regs, table[state.pc]);
+
+	state.sp = regs.sp / sizeof(Datum);
+	state.fp = regs.fp;
+	state.pc = regs.pc;
+	state.cycles = regs.cycles;
+
+	return status;
+}
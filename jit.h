@@ -0,0 +1,115 @@
+/********************************************************************************************//**
+ * @file jit.h
+ *
+ * class Jit, a template based x86-64 compiler for hot P machine procedures.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	JIT_H
+#define	JIT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "cfg.h"
+#include "datum.h"
+#include "instr.h"
+
+/********************************************************************************************//**
+ * A baseline JIT compiler
+ *
+ * Procedures are found from the program's CFG; a procedure is the blocks reachable from the
+ * program entry, or from a CALLI or TCALLI target, without following calls. Each call to a
+ * procedure, and each backward jump within it, counts towards it's heat; once it reaches the
+ * threshold, the procedure is compiled, one machine code template per instruction, into it's own
+ * mmap'd, then read-only and executable, buffer.
+ *
+ * Native code works on the machine's own stack, frame and pc, so control may pass between the
+ * machine and native code at any instruction. Native code is entered via a table of entry points,
+ * indexed by pc. It exits back to the machine at any instruction it doesn't handle, and at any
+ * instruction whose operands aren't integers, or that would fail, which the machine then
+ * executes, or reports, as usual. Calls, tail calls, returns and jumps to compiled code stay
+ * native.
+ *
+ * Only built for x86-64; elsewhere load() fails and the machine interprets everything.
+ ************************************************************************************************/
+class Jit {
+public:
+	/// Why native code returned
+	enum Status {
+		Continue,							///< Continue interpreting at pc
+		Called								///< Called pc, which isn't compiled
+	};
+
+	/// Machine registers, shared with native code
+	struct State {
+		Datum*			stack;				///< The data segment
+		size_t			sp;					///< Top of stack register
+		size_t			fp;					///< Frame pointer register
+		size_t			pc;					///< Program counter register
+		size_t			limit;				///< Pushes fail if sp is at, or beyond, this
+		size_t			cycles;				///< Number of instructions run natively
+	};
+
+	Jit(unsigned hot);						///< Constructor
+	Jit(const Jit&) = delete;				///< No copies; I own executable memory
+	Jit& operator=(const Jit&) = delete;	///< No copies; I own executable memory
+	virtual ~Jit();
+
+	/// Prepare to compile code's procedures...
+	bool load(const InstrVector& code);
+
+	/// Note a call, or backward jump, to addr...
+	void count(size_t addr);
+
+	/// Return the native entry point for pc, or nullptr
+	const void* entry(size_t pc) const		{	return pc < table.size() ? table[pc] : nullptr;	}
+
+	/// Run native code, from state.pc, until it exits...
+	Status run(State& state);
+
+	/// Return the number of procedures compiled
+	unsigned compiled() const				{	return nCompiled;	}
+
+private:
+	class Assembler;						///< Machine code buffer
+	class Procedure;						///< Compiles a procedure
+
+	/// Registers, as native code sees them; sp, and limit, are byte offsets into stack
+	struct Native {
+		Datum*				stack;			///< The data segment
+		size_t				sp;				///< Top of stack, as a byte offset
+		size_t				fp;				///< Frame pointer register
+		size_t				pc;				///< Program counter register
+		const void* const*	table;			///< Native entry points, indexed by pc
+		size_t				limit;			///< Push limit, as a byte offset
+		size_t				cycles;			///< Number of instructions run
+	};
+
+	/// An executable buffer
+	struct Buffer {
+		void*			base;				///< The mapping
+		size_t			length;				///< The mapping's size
+	};
+
+	unsigned					hot;		///< Compile procedures this hot
+	unsigned					nCompiled;	///< Number of procedures compiled
+	CFG							cfg;		///< The program; block lines are addresses
+	std::vector<size_t>			owner;		///< Entry block of each block's procedure, or CFG::none
+	std::vector<size_t>			procOf;		///< Entry block of each address's procedure, or CFG::none
+	std::vector<unsigned>		heat;		///< Calls and back jumps, indexed by entry block
+	std::vector<const void*>	table;		///< Native entry points, indexed by pc
+	std::vector<Buffer>			buffers;	///< Compiled procedures
+	Buffer						stub;		///< The entry stub
+
+	/// Copy code into a new executable buffer...
+	bool install(const std::vector<uint8_t>& code, Buffer& buffer);
+
+	bool prologue();						///< Build the entry stub
+	void compile(size_t entry);				///< Compile the procedure entered at block entry...
+};
+
+#endif
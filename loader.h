@@ -0,0 +1,31 @@
+/********************************************************************************************//**
+ * @file loader.h
+ *
+ * class Loader, compiles deferred subroutines on behalf of the machine.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	LOADER_H
+#define	LOADER_H
+
+#include <cstddef>
+
+/********************************************************************************************//**
+ * A Loader of deferred subroutines
+ *
+ * A lazily compiled program calls a stub, OpCode::COMPILE ,n, in place of each subroutine whose
+ * body has yet to be compiled. The machine asks it's loader to compile subroutine n, appending
+ * it's code to the program, and then continues at the subroutine's entry. The loader patches the
+ * stub, and the calls to it, so the subroutine is compiled only once.
+ ************************************************************************************************/
+class Loader {
+public:
+	virtual ~Loader() {}					///< Destructor
+
+	/// Compile deferred subroutine n, returning it's entry address...
+	virtual bool load(size_t n, size_t& entry) = 0;
+};
+
+#endif
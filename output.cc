@@ -0,0 +1,157 @@
+/********************************************************************************************//**
+ * @file output.cc
+ *
+ * class Output implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "output.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+/************************************************************************************************
+ * class Output
+ ************************************************************************************************/
+
+// private
+
+/********************************************************************************************//**
+ * @param	width	The field width; no padding if width <= len
+ * @param	len		The length of the value
+ ************************************************************************************************/
+void Output::pad(int width, size_t len) {
+	for (size_t i = len; width > 0 && i < static_cast<size_t>(width); ++i)
+		put(' ');
+}
+
+/********************************************************************************************//**
+ * Standard error writes, once tied, come here.
+ *
+ * @return	0
+ ************************************************************************************************/
+int Output::sync() {
+	drain();
+	os.flush();
+	return 0;
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	os		The underlying stream
+ * @param	size	The size of the buffer, in bytes
+ ************************************************************************************************/
+Output::Output(ostream& os, size_t size)
+	: os{os}, buffer(size > 0 ? size : 1), n{0}, tied{this}, oldTie{cerr.tie(&tied)}
+{
+}
+
+/********************************************************************************************//**
+ ************************************************************************************************/
+Output::~Output() {
+	drain();
+	cerr.tie(oldTie);
+}
+
+/********************************************************************************************//**
+ * @param	s	The bytes to write
+ * @param	len	The number of bytes
+ ************************************************************************************************/
+void Output::put(const char* s, size_t len) {
+	if (len > buffer.size() - n) {
+		drain();
+		if (len > buffer.size()) {
+			os.write(s, len);
+			return;
+		}
+	}
+
+	copy(s, s + len, buffer.begin() + n);
+	n += len;
+}
+
+/********************************************************************************************//**
+ * @param	c		The character
+ * @param	width	The field width
+ ************************************************************************************************/
+void Output::put(char c, int width) {
+	pad(width, 1);
+	put(c);
+}
+
+/********************************************************************************************//**
+ * @param	b	The value
+ ************************************************************************************************/
+void Output::put(bool b) {
+	if (b)
+		put("true", 4);
+	else
+		put("false", 5);
+}
+
+/********************************************************************************************//**
+ * @param	i		The value
+ * @param	width	The field width
+ ************************************************************************************************/
+void Output::put(int i, int width) {
+	char digits[16];
+	char* p = digits + sizeof(digits);
+	unsigned u = i < 0 ? 0u - static_cast<unsigned>(i) : static_cast<unsigned>(i);
+	do {
+		*--p = '0' + u % 10;
+		u /= 10;
+	} while (u != 0);
+	if (i < 0)
+		*--p = '-';
+
+	const size_t len = digits + sizeof(digits) - p;
+	pad(width, len);
+	put(p, len);
+}
+
+/********************************************************************************************//**
+ * A negative precision is the default, 6, as it is for an ostream.
+ *
+ * @param	r			The value
+ * @param	width		The field width
+ * @param	precision	Digits following the decimal point
+ * @param	fixed		Fixed, rather than scientific, notation?
+ ************************************************************************************************/
+void Output::put(double r, int width, int precision, bool fixed) {
+	const char* const format = fixed ? "%.*f" : "%.*e";
+	if (precision < 0)
+		precision = 6;
+
+	char digits[64];
+	int len = snprintf(digits, sizeof(digits), format, precision, r);
+	if (len < 0)
+		return;
+
+	pad(width, len);
+	if (static_cast<size_t>(len) < sizeof(digits))
+		put(digits, len);
+
+	else {									// e.g., 1e300 in fixed notation
+		string s(len + 1, '\0');
+		snprintf(&s[0], s.size(), format, precision, r);
+		put(s.data(), len);
+	}
+}
+
+/********************************************************************************************//**
+ * The underlying stream isn't flushed, so this is cheap enough to call before anything else
+ * writes to it, or reads from a stream tied to it.
+ ************************************************************************************************/
+void Output::drain() {
+	if (n > 0) {
+		os.write(buffer.data(), n);
+		n = 0;
+	}
+}
@@ -0,0 +1,60 @@
+/********************************************************************************************//**
+ * @file output.h
+ *
+ * class Output, the machine's buffered standard output.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	OUTPUT_H
+#define	OUTPUT_H
+
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+/********************************************************************************************//**
+ * A buffered output stream
+ *
+ * Values are formatted directly into a large buffer, rather than via iostream manipulators, and
+ * written to the underlying stream when the buffer fills, when drained, e.g., before reading
+ * input, and on destruction. Formatting matches what an ostream, in the "C" locale, writes for
+ * the same width and precision, so the output is byte for byte the same.
+ *
+ * Standard error is tied to the buffer while it exists, in place of standard output, so any
+ * error message still follows the output that preceded it.
+ ************************************************************************************************/
+class Output : private std::streambuf {
+public:
+	/// Construct a buffer of size bytes, for os...
+	explicit Output(std::ostream& os, size_t size = 64 * 1024);
+
+	virtual ~Output();						///< Destructor; drains the buffer
+
+	/// Write c
+	void put(char c)						{	if (n == buffer.size()) drain();	buffer[n++] = c;	}
+
+	void put(const char* s, size_t len);	///< Write s[0..len)
+	void put(char c, int width);			///< Write c, right justified in width
+	void put(bool b);						///< Write b as true or false
+	void put(int i, int width);				///< Write i, right justified in width
+
+	/// Write r, right justified in width, with precision digits, as fixed, or scientific notation
+	void put(double r, int width, int precision, bool fixed);
+
+	void drain();							///< Write the buffer to the underlying stream...
+
+private:
+	std::ostream&		os;					///< The underlying stream
+	std::vector<char>	buffer;				///< The buffer
+	size_t				n;					///< Number of bytes in the buffer
+	std::ostream		tied;				///< Flushes this, for standard error
+	std::ostream*		oldTie;				///< Standard error's previous tie
+
+	void pad(int width, size_t len);		///< Write spaces to right justify len bytes in width
+
+	int sync() override;					///< Drain, and flush the underlying stream
+};
+
+#endif
@@ -4,12 +4,22 @@
  * The front-end for the P Programming Language compilier and interpeter. main() runs the
  * compilier, and if no errors where encountered, passed the results to the interpreter.
  *
+ * Compiled programs may be written to, and run from, .pbc files. The compile cache keeps a .pbc
+ * file for each source, keyed by a hash of the source, compiler version and options, so that
+ * rerunning an unchanged program skips compilation. Programs run from .pbc files, including
+ * the cache, are mapped and executed in place. With --emit-cpp, the program is translated to a
+ * C++ program instead, that links with libp.a.
+ *
+ * With --profile-generate, the program is compiled without optimizations, and the run's
+ * execution counts are written to a profile, that --profile-use then feeds back to the compiler.
+ *
  * @example test/array.p
  * @example test/bitwise.p
  * @example test/bool.p
  * @example test/builtins.p
  * @example test/character.p
  * @example test/comment.p
+ * @example test/compound.p
  * @example test/divbyzero.p
  * @example test/eval.p
  * @example test/fact.p
@@ -17,41 +27,89 @@
  * @example test/fib.p
  * @example test/for.p
  * @example test/forrev.p
+ * @example test/intoverflow.p
+ * @example test/lazy.p
+ * @example test/lazyfor.p
  * @example test/min.p
  * @example test/pointers.p
  * @example test/precedence.p
  * @example test/predfail.p
  * @example test/predsucc.p
  * @example test/proc.p
+ * @example test/putformat.p
  * @example test/rcrdtest.p
  * @example test/real.p
  * @example test/repeat.p
+ * @example test/shortcircuit.p
  * @example test/simple.p
  * @example test/str.p
  * @example test/succfail.p
+ * @example test/tailcall.p
+ * @example test/tailrecord.p
  * @example test/testif.p
  * @example test/test.p
  * @example test/typefail.p
  * @example test/typetest.p
+ * @example test/uninit.p
  * @example test/unknown.p
  * @example test/varparam.p
  * eexample test/while.p
  * @example test2/get.p
+ * @example test3/arrays.p
+ * @example test3/deadcode.p
+ * @example test3/inline.p
+ * @example test3/lvalue.p
+ * @example test3/peephole.p
  ************************************************************************************************/
 
+#include "bytecode.h"
 #include "comp.h"
+#include "cppemitter.h"
 #include "interp.h"
+#include "regtranslator.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
+#include <sys/stat.h>
+
 using namespace std;
 
+static	const char* const version = "0.73";	///< The compiler version
 static	string	progName;						///< This programs name
 static 	string	inputFile {"-"};				///< Source file name, or - for standard input
 static  bool	listing = false;				///< Generate listing if true
 static 	bool	verbose = false;				///< Verbose messages if true
 static	bool	trace = false;					///< Trace run if true
+static	unsigned optimize = 0;					///< The optimization level
+static	bool	passStats = false;				///< Report optimizer pass statistics if true
+static	int		inlineLimit = -1;				///< Inline subroutines up to this size; -1 for the default
+static	bool	compileOnly = false;			///< Write a .pbc file, rather than run, if true
+static	bool	cache = false;					///< Use the compile cache if true
+static	bool	registers = false;				///< Run on the register machine if true
+static	bool	jit = false;					///< Compile hot procedures to native code if true
+static	bool	emitCpp = false;				///< Write a C++ program, rather than run, if true
+static	bool	lazy = false;					///< Compile subroutines when first called if true
+static	bool	profileGenerate = false;		///< Write a profile of the run if true
+static	bool	profileUse = false;				///< Guide the compiler with a profile if true
+static	string	profileFile;					///< The profile; inputFile's .prof file if empty
+static	bool	timePhases = false;				///< Report the time spent in each phase if true
+static	bool	phasesJson = false;				///< ...as a line of JSON if true
+
+static	Profile	profile;						///< The run's, or the training run's, profile
+static	Profile::SourceIndex profileIndex;		///< Source index of the profiled code
+static	vector<size_t> profileSites;			///< Call sites of the profiled code
+static	uint64_t profileHash = 0;				///< Hash of the profiled source
+
+static	Phases	phases;							///< Time spent in each phase, if timed
+static	bool	compiled = false;				///< Was the source compiled, rather than loaded?
 
 /********************************************************************************************//** 
  * Print a usage message on standard error output 
@@ -59,20 +117,37 @@ static	bool	trace = false;					///< Trace run if true
 static void help() {
 	cerr << "Usage: " << progName << ": [options[ [filename]\n"
 		 << "Where options is zero or more of the following:\n"
-		 << "-? | --help    Print this message and exit.\n"
-		 << "-l | --listing Generate listing.\n"
-		 << "-t | --trace   Set interpreter trace mode.\n"
-		 << "-v | --verbose Set compilier verbose mode.\n"
- 		 << "-V | --version Print the program version.\n"
+		 << "-? | --help     Print this message and exit.\n"
+		 << "-c | --compile  Write the compiled program to a .pbc file, and exit.\n"
+		 << "-C | --cache    Use the compile cache; $P_CACHE, or ~/.cache/p.\n"
+		 << "--emit-cpp      Translate the program to a C++ program, and exit.\n"
+		 << "--inline=n      Inline subroutines of up to n instructions; 0 for none, 32 with -O2.\n"
+		 << "-J | --jit      Compile hot procedures to native code; ignored if tracing, or with -R.\n"
+		 << "--lazy          Compile the program's subroutines when they're first called; implies -O0.\n"
+		 << "-l | --listing  Generate listing.\n"
+		 << "-O | --optimize Optimize; the same as -O1.\n"
+		 << "-On             Optimize at level n; 0 (none), 1 (jumps, peephole) or 2 (blocks).\n"
+		 << "--pass-stats    Report optimizer pass statistics.\n"
+		 << "--profile-generate[=file] Run unoptimized, writing a profile; file, or the source's .prof file.\n"
+		 << "--profile-use[=file] Guide optimization, and inlining, with a profile.\n"
+		 << "-R | --registers Run on the register machine; ignored if tracing.\n"
+		 << "-t | --trace    Set interpreter trace mode.\n"
+		 << "--time-phases[=json] Report the time spent in each phase, on standard error.\n"
+		 << "-v | --verbose  Set compilier verbose mode.\n"
+ 		 << "-V | --version  Print the program version.\n"
+		 << "\n"
+		 << "filename  The name of the source file, or '-' or '' for standard input.\n"
+		 << "          A .pbc file is run without compiling.\n"
 		 << "\n"
-		 << "filename  The name of the source file, or '-' or '' for standard input.\n";
+		 << "The compile cache is always used if P_CACHE is set to a directory.\n"
+		 << "With -J, a procedure is hot after $P_JIT_HOT (1000) calls, or loop iterations.\n";
 }
 
 /********************************************************************************************//**
  * Print the version number as major.minor
  ************************************************************************************************/
 static void printVersion() {
-	cout << progName << ": verson: 0.48\n";
+	cout << progName << ": verson: " << version << "\n";
 }
 
 /********************************************************************************************//** 
@@ -92,10 +167,52 @@ static bool parseCommandline(const vector<string>& args) {
 			help();
 			return false;
 
-		} else if ("--listing" == arg)
+		} else if ("--cache" == arg)
+			cache = true;						// use the compile cache...
+
+		else if ("--compile" == arg)
+			compileOnly = true;					// write a .pbc file...
+
+		else if ("--emit-cpp" == arg)
+			emitCpp = true;						// write a .cc file...
+
+		else if (0 == arg.compare(0, 9, "--inline=") && arg.size() > 9
+				&& arg.find_first_not_of("0123456789", 9) == string::npos)
+			inlineLimit = min(strtoul(arg.c_str() + 9, nullptr, 10), 1000ul); // inline small subroutines...
+
+		else if ("--jit" == arg)
+			jit = true;							// compile hot procedures...
+
+		else if ("--lazy" == arg)
+			lazy = true;						// compile subroutines when called...
+
+		else if ("--listing" == arg)
 			listing = true;
 
-		else if ("--trace" == arg)
+		else if ("--optimize" == arg)
+			optimize = 1;						// optimize the code...
+
+		else if ("--pass-stats" == arg)
+			passStats = true;
+
+		else if (0 == arg.compare(0, 18, "--profile-generate") && (arg.size() == 18 || '=' == arg[18])) {
+			profileGenerate = true;				// write a profile...
+			if (arg.size() > 18)
+				profileFile = arg.substr(19);
+
+		} else if (0 == arg.compare(0, 13, "--profile-use") && (arg.size() == 13 || '=' == arg[13])) {
+			profileUse = true;					// read a profile...
+			if (arg.size() > 13)
+				profileFile = arg.substr(14);
+
+		} else if ("--registers" == arg)
+			registers = true;					// translate to register code...
+
+		else if ("--time-phases" == arg || "--time-phases=json" == arg) {
+			timePhases = true;					// time each phase...
+			phasesJson = arg.size() > 13;
+
+		} else if ("--trace" == arg)
 			trace = true;						// Trace...
 
 		else if ("--verbose" == arg)
@@ -108,7 +225,17 @@ static bool parseCommandline(const vector<string>& args) {
 			for (unsigned n = 1; n < arg.size(); ++n)
 				switch(arg[n]) {
 				case '?':	help();				return false;
+				case 'c':	compileOnly = true;	break;
+				case 'C':	cache = true;		break;
+				case 'J':	jit = true;			break;
 				case 'l':	listing = true;		break;
+				case 'O':							// -O, or -On
+					optimize = 1;
+					if (n + 1 < arg.size() && isdigit(arg[n + 1]))
+						optimize = min(2, arg[++n] - '0');
+					break;
+
+				case 'R':	registers = true;	break;
 				case 't':	trace = true;		break;
 				case 'v':	verbose = true;		break;
 				case 'V':	printVersion();		break;
@@ -124,9 +251,221 @@ static bool parseCommandline(const vector<string>& args) {
 
 	if (inputFile.empty())
 		inputFile = "-";					// Default to standard input
+	if (profileGenerate || lazy) {			// Train on, or extend, plain code, that maps to the source
+		optimize = 0;
+		inlineLimit = 0;
+		registers = jit = false;
+	}
+
+	if (inlineLimit < 0)
+		inlineLimit = optimize >= 2 ? 32 : 0;
+	return true;
+}
+
+/********************************************************************************************//**
+ * @param	fName	A file name
+ * @param	ext		A file name extension, e.g., ".p"
+ * @return	true if fName ends with ext
+ ************************************************************************************************/
+static bool hasExtension(const string& fName, const string& ext) {
+	return fName.size() > ext.size() && 0 == fName.compare(fName.size() - ext.size(), ext.size(), ext);
+}
+
+/********************************************************************************************//**
+ * @param[out]	source	The contents of inputFile
+ * @return	false if inputFile couldn't be read
+ ************************************************************************************************/
+static bool readSource(string& source) {
+	ifstream in(inputFile, ios::binary);
+	if (!in.is_open())
+		return false;
+
+	ostringstream oss;
+	oss << in.rdbuf();
+	source = oss.str();
 	return true;
 }
 
+/********************************************************************************************//**
+ * Return the compile cache directory, creating it if necessary; $P_CACHE if set, otherwise
+ * ~/.cache/p if the cache was requested.
+ *
+ * @return	The cache directory, or "" if the cache is not in use, or can't be created.
+ ************************************************************************************************/
+static string cacheDir() {
+	string dir;
+	if (const char* env = getenv("P_CACHE"))
+		dir = env;
+	else if (cache && getenv("HOME") != nullptr) {
+		dir = string(getenv("HOME")) + "/.cache";
+		mkdir(dir.c_str(), 0755);
+		dir += "/p";
+	}
+
+	if (!dir.empty() && 0 != mkdir(dir.c_str(), 0755) && EEXIST != errno) {
+		if (verbose)
+			cout << progName << ": can't create the compile cache '" << dir << "'\n";
+		dir.clear();
+	}
+
+	return dir;
+}
+
+/********************************************************************************************//**
+ * @return	profileFile, or inputFile with it's extension replaced by .prof
+ ************************************************************************************************/
+static string profileName() {
+	if (!profileFile.empty())
+		return profileFile;
+
+	return (hasExtension(inputFile, ".p") ? inputFile.substr(0, inputFile.size() - 2) : inputFile) + ".prof";
+}
+
+/********************************************************************************************//**
+ * Translate code into a C++ program, written to inputFile, with it's extension replaced by .cc
+ *
+ * @param	code	The program
+ * @return	The number of errors
+ ************************************************************************************************/
+static unsigned translate(const InstrVector& code) {
+	const string base = hasExtension(inputFile, ".pbc") ? inputFile.substr(0, inputFile.size() - 4)
+					  : hasExtension(inputFile, ".p")   ? inputFile.substr(0, inputFile.size() - 2)
+					  : inputFile;
+	const string name = base + ".cc";
+
+	ofstream out(name);
+	if (!out) {
+		cerr << progName << ": can't create '" << name << "'\n";
+		return 1;
+	}
+
+	if (!CppEmitter()(code, inputFile, out)) {
+		cerr << progName << ": can't translate '" << inputFile << "' to C++\n";
+		return 1;
+	}
+
+	if (verbose)
+		cout << progName << ": wrote '" << name << "'\n";
+	return 0;
+}
+
+/********************************************************************************************//**
+ * Compile inputFile, or load it if it's a .pbc file. The compile cache is consulted, and
+ * updated, if it's in use and a listing wasn't requested; compiles with warnings aren't cached. If compileOnly, the program is
+ * written to inputFile, with it's extension replaced by .pbc.
+ *
+ * .pbc files, including those in the cache, are mapped into pbc, rather than read into code,
+ * unless their instructions are needed, i.e., for a listing, to write another .pbc file, or to
+ * translate to register code, compile to native code, or translate to C++.
+ *
+ * If lazy, comp compiles the program's subroutines as the machine calls them, so it outlives
+ * the compile.
+ *
+ * @param		comp	The compiler
+ * @param[out]	code	The program, if compiled or read
+ * @param[out]	pbc		The program, if mapped
+ * @return	The number of errors
+ ************************************************************************************************/
+static unsigned compile(PComp& comp, InstrVector& code, Bytecode& pbc) {
+	Bytecode::SourceIndex	index;
+	Phases* const			times = timePhases ? &phases : nullptr;
+
+	if (compileOnly && "-" == inputFile) {
+		cerr << progName << ": can't write a .pbc file for standard input\n";
+		return 1;
+
+	} else if (emitCpp && "-" == inputFile) {
+		cerr << progName << ": can't write a .cc file for standard input\n";
+		return 1;
+
+	} else if ((profileGenerate || profileUse) && ("-" == inputFile || hasExtension(inputFile, ".pbc"))) {
+		cerr << progName << ": can only profile a source file\n";
+		return 1;
+
+	} else if (lazy && (listing || compileOnly || emitCpp || profileGenerate || profileUse
+			|| hasExtension(inputFile, ".pbc"))) {
+		cerr << progName << ": can only run a source file lazily, without a listing or profile\n";
+		return 1;
+	}
+
+	if (hasExtension(inputFile, ".pbc")) {		// Load a compiled program
+		Phases::Timer timer(times, Phases::Load);
+		if (listing || registers || jit || emitCpp ? !pbc.read(inputFile, 0, code, index) : !pbc.map(inputFile, 0)) {
+			cerr << progName << ": " << pbc.error() << "\n";
+			return 1;
+		}
+
+		if (listing)							// Just disassemble, there's no source
+			for (unsigned loc = 0; loc < code.size(); ++loc)
+				disasm(cout, loc, code[loc]);
+		return emitCpp ? translate(code) : 0;
+	}
+
+	uint64_t	key = 0;						// Key the source, version and options
+	string		cached;							// The cached .pbc file, if any
+	string		source;
+	const string dir = "-" != inputFile && !listing && !profileGenerate && !profileUse && !lazy ? cacheDir() : "";
+	if ("-" != inputFile && (compileOnly || !dir.empty()) && readSource(source))
+		key = Bytecode::hash(source, Bytecode::hash(string(version) + (optimize ? " -O" + to_string(optimize) : "")
+			+ (inlineLimit ? " --inline=" + to_string(inlineLimit) : "")));
+
+	bool hit = false;
+	if (!dir.empty() && 0 != key) {
+		ostringstream oss;
+		oss << dir << '/' << hex << setw(16) << setfill('0') << key << ".pbc";
+		cached = oss.str();
+
+		Phases::Timer timer(times, Phases::Load);
+		hit = compileOnly || registers || jit || emitCpp ? pbc.read(cached, key, code, index) : pbc.map(cached, key);
+		if (hit && verbose)
+			cout << progName << ": loaded '" << cached << "' from the compile cache\n";
+	}
+
+	if ((profileGenerate || profileUse) && readSource(source))
+		profileHash = Bytecode::hash(source);
+
+	if (profileUse) {							// Compile without the profile if it's unusable
+		if (profile.read(profileName(), profileHash))
+			comp.profile(&profile);
+		else
+			cerr << progName << ": ignoring profile; " << profile.error() << "\n";
+	}
+
+	if (!hit) {
+		comp.inlineLimit(inlineLimit);
+		comp.lazy(lazy);
+		comp.phases(times);
+		compiled = true;
+		const unsigned nErrors = comp(inputFile, code, listing, verbose, optimize, passStats);
+		if (0 != nErrors)
+			return nErrors;
+
+		index = comp.sourceIndex();
+		if (profileGenerate) {
+			profileIndex = index;
+			profileSites = comp.callSites();
+		}
+
+		// A cache hit skips the compile, so a compile with warnings isn't cached, lest they're lost
+		if (!cached.empty() && 0 == comp.warnings() && !pbc.write(cached, key, code, index) && verbose)
+			cout << progName << ": " << pbc.error() << "\n";
+	}
+
+	if (compileOnly) {
+		const string name = (hasExtension(inputFile, ".p")
+			? inputFile.substr(0, inputFile.size() - 2) : inputFile) + ".pbc";
+		if (!pbc.write(name, key, code, index)) {
+			cerr << progName << ": " << pbc.error() << "\n";
+			return 1;
+		}
+
+		if (verbose)
+			cout << progName << ": wrote '" << name << "'\n";
+	}
+
+	return emitCpp ? translate(code) : 0;
+}
+
 /********************************************************************************************//** 
  * 'P' compiler and interpreter
  *
@@ -137,9 +476,10 @@ static bool parseCommandline(const vector<string>& args) {
  * @return The number of compiler/interpreter errors.
  ************************************************************************************************/
 int main(int argc, char* argv[]) {
-	PComp		comp;							// The compiler...
 	PInterp 	machine;						// The machine...
+	PComp		comp;							// The compiler...
 	InstrVector	code;							// Machine instructions...
+	Bytecode	pbc(version);					// ...or a mapped program
 	unsigned 	nErrors = 0;
 
 	progName = argv[0];
@@ -148,10 +488,11 @@ int main(int argc, char* argv[]) {
 	for (int argn = 1; argn < argc; ++argn)
 		args.push_back(argv[argn]);
 
-	if (!parseCommandline(args))
+	const bool parsed = parseCommandline(args);
+	if (!parsed)
 		++nErrors;
 												// Compile the source, run if no errors
-	else if (0 == (nErrors = comp(inputFile, code, listing, verbose))) {
+	else if (0 == (nErrors = compile(comp, code, pbc)) && !compileOnly && !emitCpp) {
 		if (verbose) {
 			if (inputFile == "-")
 				cout << progName << ": loading program from standard input, and starting P...\n";
@@ -159,11 +500,54 @@ int main(int argc, char* argv[]) {
 				cout << progName << ": loading program '" << inputFile << "', and starting P...\n";
 		}
 
-		const Result r = machine(code, trace);
+		RegInstrVector rcode;					// Translate to register code?
+		auto start = Phases::Clock::now();
+		const bool regs = registers && !trace && RegTranslator()(code, rcode);
+		phases.add(Phases::Load, Phases::Clock::now() - start);
+		if (regs && verbose)
+			cout	<< progName << ": translated " << code.size() << " instructions into "
+					<< rcode.size() << " register instructions\n";
+		if (regs && listing)
+			for (unsigned loc = 0; loc < rcode.size(); ++loc)
+				disasm(cout, loc, rcode[loc]);
+
+		unsigned hot = 0;						// Compile hot procedures?
+		if (jit && !regs) {
+			const char* env = getenv("P_JIT_HOT");
+			hot = env != nullptr && atoi(env) > 0 ? atoi(env) : 1000;
+		}
+
+		if (profileGenerate)
+			machine.profile(&profile);
+		if (lazy)
+			machine.lazy(&comp);
+
+		start = Phases::Clock::now();
+		const Result r = regs ? machine(rcode)
+					   : pbc.records() != nullptr ? machine(pbc, trace) : machine(code, trace, hot);
+		phases.add(Phases::Run, Phases::Clock::now() - start);
 		if (Result::success != r)
 			nErrors = static_cast<int> (r);		// Return error code 
 
+		if (verbose && hot > 0)
+			cout << progName << ": compiled " << machine.compiled() << " procedures to native code\n";
 		if (verbose) cout << progName << ": Ending P after " << machine.cycles() << " machine cycles\n";
+
+		if (profileGenerate) {					// A failed run is still a profile
+			if (!profile.write(profileName(), profileHash, profileIndex, profileSites)) {
+				cerr << progName << ": " << profile.error() << "\n";
+				++nErrors;
+
+			} else if (verbose)
+				cout << progName << ": wrote '" << profileName() << "'\n";
+		}
+	}
+
+	if (parsed && timePhases) {					// Includes subroutines compiled lazily
+		if (compiled)
+			comp.tally(phases);
+		phases.count(Phases::Instructions, pbc.records() != nullptr ? pbc.size() : code.size());
+		phases.write(cerr, version, inputFile, phasesJson);
 	}
 
 	return nErrors;
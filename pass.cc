@@ -0,0 +1,95 @@
+/********************************************************************************************//**
+ * @file pass.cc
+ *
+ * class PassManager implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "pass.h"
+#include "compilier.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+/************************************************************************************************
+ * class PassManager
+ ************************************************************************************************/
+
+// public
+
+/********************************************************************************************//**
+ * @param	progName	Program name, used in log messages
+ * @param	stats		Report per-pass statistics on standard output if true
+ ************************************************************************************************/
+PassManager::PassManager(const string& progName, bool stats) : progName{progName}, stats{stats} {
+}
+
+/********************************************************************************************//**
+ * @param	level	The minimum optimization level that enables pass
+ * @param	pass	The pass; I take ownership
+ ************************************************************************************************/
+void PassManager::add(unsigned level, Pass* pass) {
+	passes.push_back(Entry { level, unique_ptr<Pass>(pass) });
+}
+
+/********************************************************************************************//**
+ * Code that can't be represented as a CFG, e.g., uses computed addresses, is left as is.
+ *
+ * @param	level	The optimization level; zero runs no passes
+ * @param	code	The code to optimize
+ * @param	index	code's source cross index, indexed by instruction address
+ *
+ * @return	The total number of changes made
+ ************************************************************************************************/
+unsigned PassManager::operator()(unsigned level, InstrVector& code, SourceIndex& index) {
+	typedef chrono::steady_clock Clock;
+
+	if (0 == level)
+		return 0;
+
+	CFG cfg;
+	if (!cfg.build(code, index)) {
+		if (stats)
+			cout << prefix(progName) << "passes: code uses computed addresses; not optimized\n";
+		return 0;
+	}
+
+	const size_t before = code.size();
+	if (stats)
+		cout	<< prefix(progName) << "passes: -O" << level << ", " << before << " instructions, "
+				<< cfg.blocks().size() << " blocks\n";
+
+	unsigned total = 0;
+	for (auto& entry : passes) {
+		if (entry.level > level)
+			continue;
+
+		const size_t n = cfg.nInstrs();
+		const auto start = Clock::now();
+		const unsigned changes = (*entry.pass)(cfg);
+		const chrono::duration<double, micro> elapsed = Clock::now() - start;
+		total += changes;
+
+		if (stats)
+			cout	<< prefix(progName) << "pass " << left << setw(14) << entry.pass->name() << right
+					<< setw(6) << changes << " changes, " << setw(6) << n << " -> " << setw(6)
+					<< cfg.nInstrs() << " instructions, " << fixed << setprecision(1)
+					<< elapsed.count() << " us\n" << defaultfloat;
+	}
+
+	const auto start = Clock::now();
+	cfg.lower(code, index);
+	const chrono::duration<double, micro> elapsed = Clock::now() - start;
+
+	if (stats)
+		cout	<< prefix(progName) << "passes: " << total << " changes, " << before << " -> "
+				<< code.size() << " instructions, lowered in " << fixed << setprecision(1)
+				<< elapsed.count() << " us\n" << defaultfloat;
+
+	return total;
+}
@@ -0,0 +1,70 @@
+/********************************************************************************************//**
+ * @file pass.h
+ *
+ * class Pass, an optimization pass, and class PassManager, which runs them.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	PASS_H
+#define	PASS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cfg.h"
+
+/********************************************************************************************//**
+ * An optimization pass over a control flow graph
+ ************************************************************************************************/
+class Pass {
+public:
+	Pass(const std::string& name) : _name{name} {}	///< Constructor
+	virtual ~Pass() {}						///< Destructor
+
+	const std::string& name() const			{	return _name;	}	///< Return my name
+
+	/// Run the pass over cfg, returning the number of changes made
+	virtual unsigned operator()(CFG& cfg) = 0;
+
+private:
+	std::string			_name;				///< The pass name, used in reports
+};
+
+/********************************************************************************************//**
+ * Runs optimization passes
+ *
+ * Passes are added with the minimum optimization level that enables them, and run in the order
+ * added. The code is built into a CFG, passed through each enabled pass, and then lowered back
+ * into code. If stats are requested, each pass's changes, and run time, are reported on standard
+ * output, along with the size of the code before and after.
+ ************************************************************************************************/
+class PassManager {
+public:
+	/// A table, indexed by instruction address, yeilding source line numbers...
+	typedef CFG::SourceIndex SourceIndex;
+
+	PassManager(const std::string& progName, bool stats);	///< Constructor
+	virtual ~PassManager() {}				///< Destructor
+
+	/// Add pass, enabled at level, and above...
+	void add(unsigned level, Pass* pass);
+
+	/// Optimize code, and it's source index, at level...
+	unsigned operator()(unsigned level, InstrVector& code, SourceIndex& index);
+
+private:
+	/// A pass, and it's enabling level
+	struct Entry {
+		unsigned				level;		///< Minimum enabling level
+		std::unique_ptr<Pass>	pass;		///< The pass
+	};
+
+	std::string			progName;			///< Name used in log messages
+	bool				stats;				///< Report per-pass statistics if true
+	std::vector<Entry>	passes;				///< The passes, in order
+};
+
+#endif
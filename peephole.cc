@@ -0,0 +1,218 @@
+/********************************************************************************************//**
+ * @file peephole.cc
+ *
+ * class Peephole implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "peephole.h"
+#include "compilier.h"
+
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+/************************************************************************************************
+ * class Peephole
+ ************************************************************************************************/
+
+// private static
+
+/********************************************************************************************//**
+ * Pattern names, indexed by Pattern
+ ************************************************************************************************/
+const char* const Peephole::names[NPatterns] = {
+	"push 1/mul",
+	"push 1/div",
+	"push 0/add",
+	"push 0/sub",
+	"push c/neg",
+	"push c/itor",
+	"dup/pop",
+	"pushvar/push c/add",
+	"enter 0"
+};
+
+// private
+
+/********************************************************************************************//**
+ * @param	p	The pattern applied
+ * @param	b	The block number
+ * @param	pc	Offset of the patterns first instruction in block b
+ ************************************************************************************************/
+void Peephole::hit(Pattern p, size_t b, size_t pc) {
+	++hits[p];
+	if (verbose)
+		cout << prefix(progName) << "peephole " << names[p] << " at " << b << ':' << pc << '\n';
+}
+
+/********************************************************************************************//**
+ * Constants are only rewritten if the rewrite can't change the result, e.g., negating the
+ * minimum integer is left for the machine to evaluate.
+ *
+ * @param	code	The block's code to rewrite
+ * @param	b		The block number, for verbose reports
+ * @param	pc		Offset of the first instruction of a candidate sequence
+ *
+ * @return	The length of the rewritten sequence, or zero if no pattern matched.
+ ************************************************************************************************/
+size_t Peephole::rewrite(InstrVector& code, size_t b, size_t pc) {
+	const size_t n = code.size() - pc;				// # of instructions available
+	if (code[pc].op == OpCode::ENTER && code[pc].value.kind() == Datum::Integer
+			&& code[pc].value.integer() == 0) {
+		hit(EnterZero, b, pc);
+		keep[pc] = false;
+		return 1;
+
+	} else if (n < 2)
+		return 0;
+
+	Instr& first = code[pc];
+	Instr& second = code[pc + 1];
+	const Datum& value = first.value;
+
+	if (first.op == OpCode::PUSH) {
+		const bool integer = value.kind() == Datum::Integer;
+		const bool real = value.kind() == Datum::Real;
+
+		if ((integer && value.integer() == 1) || (real && value.real() == 1.0)) {
+			if (second.op == OpCode::MUL || second.op == OpCode::DIV) {
+				hit(second.op == OpCode::MUL ? MulOne : DivOne, b, pc);
+				keep[pc] = keep[pc + 1] = false;
+				return 2;
+			}
+
+		} else if (integer && value.integer() == 0) {
+			if (second.op == OpCode::ADD || second.op == OpCode::SUB) {
+				hit(second.op == OpCode::ADD ? AddZero : SubZero, b, pc);
+				keep[pc] = keep[pc + 1] = false;
+				return 2;
+			}
+		}
+
+		if (second.op == OpCode::NEG) {
+			if (integer && value.integer() != numeric_limits<int>::min()) {
+				hit(PushNeg, b, pc);
+				first.value = -value.integer();
+				keep[pc + 1] = false;
+				return 2;
+
+			} else if (real) {
+				hit(PushNeg, b, pc);
+				first.value = -value.real();
+				keep[pc + 1] = false;
+				return 2;
+			}
+
+		} else if (second.op == OpCode::ITOR && integer) {
+			hit(PushItor, b, pc);
+			first.value = value.integer() * 1.0;
+			keep[pc + 1] = false;
+			return 2;
+		}
+
+	} else if (first.op == OpCode::DUP && second.op == OpCode::POP) {
+		if (second.value.kind() == Datum::Integer && second.value.integer() >= 1) {
+			hit(DupPop, b, pc);
+			keep[pc] = false;
+			if (second.value.integer() == 1)
+				keep[pc + 1] = false;
+			else
+				second.value = second.value.integer() - 1;
+			return 2;
+		}
+
+	} else if (first.op == OpCode::PUSHVAR && n >= 3) {
+		const Instr& third = code[pc + 2];
+		if (second.op == OpCode::PUSH && second.value.kind() == Datum::Integer && third.op == OpCode::ADD) {
+			const long long offset =
+				static_cast<long long>(value.integer()) + second.value.integer();
+			if (offset >= numeric_limits<int>::min() && offset <= numeric_limits<int>::max()) {
+				hit(PushVarAdd, b, pc);
+				first.value = static_cast<int>(offset);
+				keep[pc + 1] = keep[pc + 2] = false;
+				return 3;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/********************************************************************************************//**
+ * Discard instructions, and their source line numbers, not marked as keep.
+ *
+ * @param	block	The block to compact
+ ************************************************************************************************/
+void Peephole::compact(CFG::Block& block) {
+	size_t to = 0;
+	for (size_t pc = 0; pc < block.code.size(); ++pc)
+		if (keep[pc]) {
+			block.code[to] = block.code[pc];
+			block.lines[to] = block.lines[pc];
+			++to;
+		}
+
+	block.code.resize(to);
+	block.lines.resize(to);
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	name		Program name, used in log messages
+ * @param	verbose		Write each rewrite, and a summary, on standard output if true
+ ************************************************************************************************/
+Peephole::Peephole(const string& name, bool verbose)
+	: Pass("peephole"), progName{name}, verbose{verbose}
+{
+	for (auto& h : hits)
+		h = 0;
+}
+
+/********************************************************************************************//**
+ * @param	cfg	The graph to optimize
+ * @return	The total number of rewrites.
+ ************************************************************************************************/
+unsigned Peephole::operator()(CFG& cfg) {
+	const size_t before = cfg.nInstrs();
+	for (auto& h : hits)
+		h = 0;
+
+	CFG::BlockVec& blocks = cfg.blocks();
+	for (size_t b = 0; b < blocks.size(); ++b) {
+		InstrVector& code = blocks[b].code;
+		if (blocks[b].removed)
+			continue;
+
+		bool changed;
+		do {
+			changed = false;
+			keep.assign(code.size(), true);
+			for (size_t pc = 0; pc < code.size(); ) {
+				const size_t n = rewrite(code, b, pc);
+				if (n > 0)
+					changed = true;
+				pc += n > 0 ? n : 1;
+			}
+
+			compact(blocks[b]);
+		} while (changed);
+	}
+
+	unsigned total = 0;
+	for (auto h : hits)
+		total += h;
+
+	if (verbose) {
+		for (unsigned p = 0; p < NPatterns; ++p)
+			cout << prefix(progName) << "peephole " << names[p] << ": " << hits[p] << '\n';
+		cout	<< prefix(progName) << "peephole: " << total << " rewrites, "
+				<< before - cfg.nInstrs() << " instructions removed\n";
+	}
+
+	return total;
+}
@@ -0,0 +1,65 @@
+/********************************************************************************************//**
+ * @file peephole.h
+ *
+ * class Peephole, a peephole optimizer for emitted P machine code.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	PEEPHOLE_H
+#define	PEEPHOLE_H
+
+#include <string>
+#include <vector>
+
+#include "pass.h"
+
+/********************************************************************************************//**
+ * A peephole optimizer
+ *
+ * Rewrites short, local, instruction sequences into cheaper ones, e.g., "push 0; add" is removed,
+ * and "push 3; neg" becomes "push -3". Patterns are matched within basic blocks, so they never
+ * span a jump target. Each block is rewritten until nothing changes, as one rewrite may expose
+ * another.
+ ************************************************************************************************/
+class Peephole : public Pass {
+public:
+	Peephole(const std::string& name, bool verbose); ///< Constructor
+
+	/// Optimize the blocks of cfg...
+	unsigned operator()(CFG& cfg) override;
+
+private:
+	/// Rewrite patterns
+	enum Pattern {
+		MulOne,								///< push 1; mul
+		DivOne,								///< push 1; div
+		AddZero,							///< push 0; add
+		SubZero,							///< push 0; sub
+		PushNeg,							///< push c; neg
+		PushItor,							///< push i; itor
+		DupPop,								///< dup; pop n
+		PushVarAdd,							///< pushvar l,o; push c; add
+		EnterZero,							///< enter 0
+
+		NPatterns							///< Number of patterns
+	};
+
+	static const char* const names[NPatterns];	///< Pattern names, for verbose reports
+
+	std::string				progName;		///< Name used in log messages
+	bool					verbose;		///< Write hit counts if true
+	unsigned				hits[NPatterns]; ///< Number of times each pattern was applied
+	std::vector<bool>		keep;			///< Instructions that survive this pass
+
+	void hit(Pattern p, size_t b, size_t pc); ///< Note that p was applied at pc in block b
+
+	/// Apply patterns at code[pc] of block b...
+	size_t rewrite(InstrVector& code, size_t b, size_t pc);
+
+	/// Discard deleted instructions from block...
+	void compact(CFG::Block& block);
+};
+
+#endif
@@ -0,0 +1,88 @@
+/********************************************************************************************//**
+ * @file phases.cc
+ *
+ * class Phases implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "phases.h"
+
+#include <iomanip>
+
+#include <sys/resource.h>
+
+using namespace std;
+
+// local
+
+namespace {
+	/// Phase names, indexed by Phases::Phase
+	const char* const phaseNames[] = { "lex", "parse", "optimize", "listing", "load", "run" };
+
+	/// Count names, indexed by Phases::Count
+	const char* const countNames[] = { "tokens", "symbols", "types", "instructions" };
+
+	/// Return d in seconds
+	double seconds(Phases::Clock::duration d) {
+		return chrono::duration<double>(d).count();
+	}
+
+	/// Return the process's peak resident set size, in kilobytes, or zero if unknown
+	long peakRss() {
+		struct rusage usage;
+		return 0 == getrusage(RUSAGE_SELF, &usage) ? usage.ru_maxrss : 0;
+	}
+}
+
+/************************************************************************************************
+ * class Phases
+ ************************************************************************************************/
+
+// public
+
+Phases::Phases() : times{}, counts{} {
+}
+
+/********************************************************************************************//**
+ * The table lists each phase's seconds, and their total, followed by the counts and the peak
+ * RSS. The JSON object has the same fields, keyed by name, along with the version and source.
+ *
+ * @param	os		Where to write the report
+ * @param	version	The compiler's version
+ * @param	source	The program's file name
+ * @param	json	Write a single line of JSON, rather than a table, if true
+ ************************************************************************************************/
+void Phases::write(ostream& os, const string& version, const string& source, bool json) const {
+	Clock::duration total { 0 };
+	for (auto t : times)
+		total += t;
+
+	if (json) {
+		os << "{\"version\": \"" << version << "\", \"source\": \"";
+		for (auto c : source)					// Escape quotes, backslashes and control characters
+			if (static_cast<unsigned char>(c) < 0x20)
+				os << "\\u00" << "0123456789abcdef"[c >> 4] << "0123456789abcdef"[c & 0xf];
+			else
+				os << ('"' == c || '\\' == c ? "\\" : "") << c;
+		os << "\"" << fixed << setprecision(6);
+		for (unsigned p = 0; p < NPhases; ++p)
+			os << ", \"" << phaseNames[p] << "\": " << seconds(times[p]);
+		os << ", \"total\": " << seconds(total);
+		for (unsigned c = 0; c < NCounts; ++c)
+			os << ", \"" << countNames[c] << "\": " << counts[c];
+		os << ", \"peak-rss-kb\": " << peakRss() << "}\n";
+		return;
+	}
+
+	os << left << setw(14) << "phase" << right << setw(12) << "seconds" << '\n'
+	   << fixed << setprecision(6);
+	for (unsigned p = 0; p < NPhases; ++p)
+		os << left << setw(14) << phaseNames[p] << right << setw(12) << seconds(times[p]) << '\n';
+	os << left << setw(14) << "total" << right << setw(12) << seconds(total) << '\n';
+
+	for (unsigned c = 0; c < NCounts; ++c)
+		os << left << setw(14) << countNames[c] << right << setw(12) << counts[c] << '\n';
+	os << left << setw(14) << "peak-rss-kb" << right << setw(12) << peakRss() << '\n';
+}
@@ -0,0 +1,86 @@
+/********************************************************************************************//**
+ * @file phases.h
+ *
+ * class Phases, the time spent in each phase of compiling and running a program.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	PHASES_H
+#define	PHASES_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/********************************************************************************************//**
+ * Phase times and counts
+ *
+ * The wall time spent in each phase, along with counts of what the compiler built, and the
+ * process's peak resident set size, reported by --time-phases. Scanning is interleaved with
+ * parsing, so lex is the time spent in TokenStream::get(), and parse is the rest of the compile,
+ * i.e., symbol lookup, type construction and emit(). Load is reading, or mapping, a .pbc file,
+ * or a compile cache entry, and translating to register code. Written as a table, or as a single
+ * line of JSON, that may be graphed across versions.
+ ************************************************************************************************/
+class Phases {
+public:
+	typedef std::chrono::steady_clock Clock;	///< The clock phases are timed with
+
+	/// Phases, in the order they're reported
+	enum Phase {
+		Lex,								///< Scanning tokens
+		Parse,								///< Parsing, and emitting code
+		Optimize,							///< Optimizer passes
+		Listing,							///< Writing the listing
+		Load,								///< Loading compiled code
+		Run,								///< Running the program
+		NPhases								///< Number of phases
+	};
+
+	/// Counts, in the order they're reported
+	enum Count {
+		Tokens,								///< Tokens read
+		Symbols,							///< Symbols declared, including built-ins
+		Types,								///< Distinct type descriptors
+		Instructions,						///< Instructions in the program
+		NCounts								///< Number of counts
+	};
+
+	/// Adds the time from it's construction to it's destruction to a phase, unless phases is nullptr
+	class Timer {
+	public:
+		/// Start timing phase
+		Timer(Phases* p, Phase ph) : phases{p}, phase{ph}, start{Clock::now()}	{}
+
+		/// Stop timing
+		~Timer()							{	if (phases) phases->add(phase, Clock::now() - start);	}
+
+	private:
+		Phases*				phases;			///< Where to add the time
+		Phase				phase;			///< The phase being timed
+		Clock::time_point	start;			///< When timing started
+	};
+
+	Phases();								///< Constructor
+
+	/// Add d to phase
+	void add(Phase phase, Clock::duration d)	{	times[phase] += d;	}
+
+	/// Return the time spent in phase
+	Clock::duration time(Phase phase) const	{	return times[phase];	}
+
+	/// Set count c to n
+	void count(Count c, uint64_t n)			{	counts[c] = n;	}
+
+	/// Write the report on os...
+	void write(std::ostream& os, const std::string& version, const std::string& source, bool json) const;
+
+private:
+	Clock::duration		times[NPhases];		///< Time spent, indexed by Phase
+	uint64_t			counts[NCounts];	///< Counts, indexed by Count
+};
+
+#endif
@@ -0,0 +1,155 @@
+/********************************************************************************************//**
+ * @file profile.cc
+ *
+ * class Profile implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "profile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+
+/************************************************************************************************
+ * class Profile
+ ************************************************************************************************/
+
+// public
+
+/********************************************************************************************//**
+ * @param	name	The file name
+ * @param	hash	The hash of the source that was run
+ * @param	index	The source line of each instruction
+ * @param	sites	The address of each call site's call, in the order the compiler reached them
+ *
+ * @return	false, and error() is set, if the profile couldn't be written
+ ************************************************************************************************/
+bool Profile::write(
+	const string&			name,
+	uint64_t				hash,
+	const SourceIndex&		index,
+	const vector<size_t>&	sites)
+{
+	ofstream out(name);
+	if (!out) {
+		_error = "can't create " + name;
+		return false;
+	}
+
+	out << "# P profile; pc addr line count taken, site n count\n"
+		<< "source " << hex << hash << dec << '\n';
+	for (size_t pc = 0; pc < counts.size(); ++pc)
+		out << "pc " << pc << ' ' << (pc < index.size() ? index[pc] : 0) << ' ' << counts[pc]
+			<< ' ' << takens[pc] << '\n';
+
+	for (size_t n = 0; n < sites.size(); ++n)
+		if (sites[n] < counts.size())
+			out << "site " << n << ' ' << counts[sites[n]] << '\n';
+
+	if (!out) {
+		_error = "can't write " + name;
+		return false;
+	}
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * @param	name	The file name
+ * @param	hash	The hash of the source to be compiled, that the profile's must match
+ *
+ * @return	false, and error() is set, if the profile couldn't be read, or is out of date
+ ************************************************************************************************/
+bool Profile::read(const string& name, uint64_t hash) {
+	ifstream in(name);
+	if (!in.is_open()) {
+		_error = "can't open " + name;
+		return false;
+	}
+
+	counts.clear();
+	takens.clear();
+	lines.clear();
+	sites.clear();
+
+	bool current = false;
+	string text;
+	for (unsigned n = 1; getline(in, text); ++n) {
+		istringstream iss(text);
+		string kind;
+		if (!(iss >> kind) || '#' == kind[0])
+			continue;
+
+		bool ok = true;
+		if ("source" == kind) {
+			uint64_t h = 0;
+			ok = static_cast<bool>(iss >> hex >> h);
+			current = h == hash;
+
+		} else if ("pc" == kind) {
+			size_t pc = 0;
+			unsigned line = 0;
+			uint64_t count = 0, taken = 0;
+			ok = static_cast<bool>(iss >> pc >> line >> count >> taken) && pc == counts.size();
+			if (ok) {
+				counts.push_back(count);
+				takens.push_back(taken);
+				lines[line] = max(lines[line], count);
+			}
+
+		} else if ("site" == kind) {
+			size_t site = 0;
+			uint64_t count = 0;
+			ok = static_cast<bool>(iss >> site >> count) && site < numeric_limits<unsigned>::max();
+			if (ok) {
+				if (site >= sites.size())
+					sites.resize(site + 1, numeric_limits<uint64_t>::max());
+				sites[site] = count;
+			}
+
+		} else
+			ok = false;
+
+		if (!ok) {
+			_error = name + ", line " + to_string(n) + ": bad record";
+			return false;
+		}
+	}
+
+	if (!current) {
+		_error = name + " is out of date";
+		return false;
+	}
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * A line is reached as often as it's most executed instruction.
+ *
+ * @param	line	The source line number
+ * @return	The number of times line was reached in the training run
+ ************************************************************************************************/
+uint64_t Profile::line(unsigned line) const {
+	const auto it = lines.find(line);
+	return it == lines.end() ? 0 : it->second;
+}
+
+/********************************************************************************************//**
+ * @param		n		The call site number, in the order the compiler reached them
+ * @param[out]	count	The number of times the site was reached
+ * @return	false if the profile doesn't know the site
+ ************************************************************************************************/
+bool Profile::site(size_t n, uint64_t& count) const {
+	if (n >= sites.size() || sites[n] == numeric_limits<uint64_t>::max())
+		return false;
+
+	count = sites[n];
+	return true;
+}
@@ -0,0 +1,80 @@
+/********************************************************************************************//**
+ * @file profile.h
+ *
+ * class Profile, execution counts from a training run, that guide the compiler.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	PROFILE_H
+#define	PROFILE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/********************************************************************************************//**
+ * An execution profile
+ *
+ * Written by a training run, i.e., --profile-generate, which counts how many times the machine
+ * executes each instruction, and how many times each conditional jump is taken. The program is
+ * compiled without optimizations, or inlining, so the counts can be mapped back to the source;
+ * each instruction's source line, and the instruction of each call site, in the order the
+ * compiler reached them, are written along with the counts. A profile is text, one record per
+ * line:
+ *
+ *     # comment
+ *     source hash              The FNV-1a hash of the source that was run
+ *     pc addr line count taken One per instruction
+ *     site n count             One per call site
+ *
+ * Read back, by --profile-use, the profile yields the number of times each source line, and each
+ * call site, was reached, as long as the source hasn't changed.
+ ************************************************************************************************/
+class Profile {
+public:
+	/// A table, indexed by instruction address, yeilding source line numbers...
+	typedef std::vector<unsigned> SourceIndex;
+
+	static const uint64_t hot = 1000;		///< A site reached this often is hot
+
+	Profile() {}							///< Constructor
+
+	/// Start counting a program of size instructions
+	void reset(size_t size)					{	counts.assign(size, 0);	takens.assign(size, 0);	}
+
+	/// Count the execution of the instruction at pc
+	void count(size_t pc)					{	if (pc < counts.size()) ++counts[pc];	}
+
+	/// Count the jump at pc as taken
+	void taken(size_t pc)					{	if (pc < takens.size()) ++takens[pc];	}
+
+	/// Write the profile to name...
+	bool write(	const std::string&			name,
+				uint64_t					hash,
+				const SourceIndex&			index,
+				const std::vector<size_t>&	sites);
+
+	/// Read the profile from name...
+	bool read(const std::string& name, uint64_t hash);
+
+	/// Return the number of times line was reached, or zero if it has no code
+	uint64_t line(unsigned line) const;
+
+	/// Was site reached, and if so, how many times?
+	bool site(size_t n, uint64_t& count) const;
+
+	/// Return a description of the last error
+	const std::string& error() const		{	return _error;	}
+
+private:
+	std::vector<uint64_t>		counts;		///< Executions, indexed by pc
+	std::vector<uint64_t>		takens;		///< Jumps taken, indexed by pc
+	std::map<unsigned, uint64_t> lines;		///< Times each line was reached, indexed by line
+	std::vector<uint64_t>		sites;		///< Times each call site was reached, in order
+	std::string					_error;		///< Last error
+};
+
+#endif
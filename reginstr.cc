@@ -0,0 +1,94 @@
+/********************************************************************************************//**
+ * @file reginstr.cc
+ *
+ * Register machine instruction format
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <iomanip>
+
+#include "reginstr.h"
+
+using namespace std;
+
+namespace {
+	/// Register operation names, indexed by RegOp
+	const char* const names[] = {
+		"stack",	"move",
+		"add",		"sub",		"mul",		"div",		"rem",
+		"lt",		"lte",		"equ",		"gte",		"gt",		"neq",
+		"jnlt",		"jnlte",	"jnequ",	"jngte",	"jngt",		"jnneq"
+	};
+
+	/// Write operand o, of instr, on out
+	void operand(ostream& out, const Operand& o, const RegInstr& instr) {
+		switch(o.mode) {
+		case Operand::Frame:	out << '[' << static_cast<int>(o.level) << ", " << o.offset << ']';	break;
+		case Operand::Const:	out << instr.instr.value;											break;
+		case Operand::Stack:	out << "tos";														break;
+		default:				out << '-';
+		}
+	}
+}
+
+/************************************************************************************************
+ * struct RegInstr
+ ************************************************************************************************/
+
+/********************************************************************************************//**
+ * @param	instr	The stack machine instruction
+ * @param	addr	instr's address
+ ************************************************************************************************/
+RegInstr::RegInstr(const Instr& instr, uint32_t addr)
+	: op{RegOp::STACK},
+	  nElements{static_cast<uint8_t>(OpCodeInfo::info(instr.op).nElements())},
+	  addr{addr},
+	  target{0},
+	  instr{instr}
+{
+}
+
+/********************************************************************************************//**
+ * @param	op		The operation
+ * @param	instr	The equivalent stack machine operation, and constant operand, if any
+ * @param	addr	The stack machine instruction's address
+ ************************************************************************************************/
+RegInstr::RegInstr(RegOp op, const Instr& instr, uint32_t addr)
+	: op{op}, nElements{0}, addr{addr}, target{0}, instr{instr}
+{
+}
+
+/********************************************************************************************//**
+ * Stack machine instructions are disassembled as such.
+ *
+ * @param	out		Where to write the results
+ * @param	loc		Address of the instruction
+ * @param	instr	The instruction to disassemble
+ * @return 	loc+1
+ ************************************************************************************************/
+unsigned disasm(ostream& out, unsigned loc, const RegInstr& instr) {
+	if (instr.op == RegOp::STACK)
+		return disasm(out, loc, instr.instr);
+
+	out << setw(5) << loc << ": " << names[static_cast<unsigned>(instr.op)] << ' ';
+	if (instr.op >= RegOp::JNLT) {
+		operand(out, instr.lhs, instr);
+		out << ", ";
+		operand(out, instr.rhs, instr);
+		out << ", " << instr.target;
+
+	} else {
+		operand(out, instr.dst, instr);
+		out << ", ";
+		operand(out, instr.lhs, instr);
+		if (instr.op != RegOp::MOVE) {
+			out << ", ";
+			operand(out, instr.rhs, instr);
+		}
+	}
+	out << "\n";
+
+	return loc + 1;
+}
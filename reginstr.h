@@ -0,0 +1,102 @@
+/********************************************************************************************//**
+ * @file reginstr.h
+ *
+ * Register machine operation codes, operands and instruction format, used by the translator
+ * (RegTranslator) and the interpreter (PInterp).
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	REGINSTR_H
+#define	REGINSTR_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "instr.h"
+
+/********************************************************************************************//**
+ * Register machine operation codes
+ *
+ * OP dst, lhs, rhs - description. Binary and branch operations also record the equivalent stack
+ * machine operation in instr.op, used to evaluate operands other than a pair of integers.
+ ************************************************************************************************/
+enum class RegOp : unsigned char {
+	STACK,		///< STACK - Execute instr, a stack machine instruction
+	MOVE,		///< MOVE dst, lhs - dst = lhs
+
+	ADD,		///< ADD dst, lhs, rhs - dst = lhs + rhs
+	SUB,		///< SUB dst, lhs, rhs - dst = lhs - rhs
+	MUL,		///< MUL dst, lhs, rhs - dst = lhs * rhs
+	DIV,		///< DIV dst, lhs, rhs - dst = lhs / rhs
+	REM,		///< REM dst, lhs, rhs - dst = lhs % rhs
+
+	LT,			///< LT dst, lhs, rhs - dst = lhs < rhs
+	LTE,		///< LTE dst, lhs, rhs - dst = lhs <= rhs
+	EQU,		///< EQU dst, lhs, rhs - dst = lhs == rhs
+	GTE,		///< GTE dst, lhs, rhs - dst = lhs >= rhs
+	GT,			///< GT dst, lhs, rhs - dst = lhs > rhs
+	NEQ,		///< NEQ dst, lhs, rhs - dst = lhs != rhs
+
+	JNLT,		///< JNLT lhs, rhs, target - jump to target unless lhs < rhs
+	JNLTE,		///< JNLTE lhs, rhs, target - jump to target unless lhs <= rhs
+	JNEQU,		///< JNEQU lhs, rhs, target - jump to target unless lhs == rhs
+	JNGTE,		///< JNGTE lhs, rhs, target - jump to target unless lhs >= rhs
+	JNGT,		///< JNGT lhs, rhs, target - jump to target unless lhs > rhs
+	JNNEQ		///< JNNEQ lhs, rhs, target - jump to target unless lhs != rhs
+};
+
+/********************************************************************************************//**
+ * A register machine operand
+ *
+ * Registers are frame slots, addressed as PUSHVAR does; base(level) + offset.
+ ************************************************************************************************/
+struct Operand {
+	/// Operand modes
+	enum Mode : uint8_t {
+		None,								///< Not used
+		Frame,								///< The frame slot base(level) + offset
+		Const,								///< The instruction's constant, instr.value
+		Stack								///< Pop (source), or push (destination), the stack
+	};
+
+	Mode		mode;						///< How to find the operand
+	int8_t		level;						///< Frame: block level
+	int32_t		offset;						///< Frame: offset from the block's base
+
+	Operand(Mode m = None, int8_t l = 0, int32_t o = 0) : mode{m}, level{l}, offset{o} {}
+};
+
+/********************************************************************************************//**
+ * A register machine instruction
+ ************************************************************************************************/
+struct RegInstr {
+	RegOp		op;							///< Operation code
+	uint8_t		nElements;					///< STACK: stack elements instr accesses
+	uint32_t	addr;						///< Address of the stack machine instruction
+	uint32_t	target;						///< Jump target
+	Operand		dst;						///< Destination
+	Operand		lhs;						///< Left hand, or only, source
+	Operand		rhs;						///< Right hand source
+	Instr		instr;						///< Stack machine instruction, and constant operand
+
+	/// Construct an instruction executing instr, from addr...
+	RegInstr(const Instr& instr, uint32_t addr);
+
+	/// Construct a register instruction, from addr...
+	RegInstr(RegOp op, const Instr& instr, uint32_t addr);
+};
+
+/********************************************************************************************//**
+ * A vector of RegInstr's (instructions)
+ ************************************************************************************************/
+typedef std::vector<RegInstr>				RegInstrVector;
+
+/********************************************************************************************//**
+ * Disassemble a register machine instruction...
+ ************************************************************************************************/
+unsigned disasm(std::ostream& out, unsigned loc, const RegInstr& instr);
+
+#endif
@@ -0,0 +1,305 @@
+/********************************************************************************************//**
+ * @file regtranslator.cc
+ *
+ * class RegTranslator implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "regtranslator.h"
+
+#include <cassert>
+
+using namespace std;
+
+/************************************************************************************************
+ * class RegTranslator
+ ************************************************************************************************/
+
+// private static
+
+/********************************************************************************************//**
+ * @param	op	The stack machine operation
+ * @return	true if op is an arithmetic, or comparison, operation
+ ************************************************************************************************/
+bool RegTranslator::binary(OpCode op) {
+	switch(op) {
+	case OpCode::ADD:
+	case OpCode::SUB:
+	case OpCode::MUL:
+	case OpCode::DIV:
+	case OpCode::REM:
+	case OpCode::LT:
+	case OpCode::LTE:
+	case OpCode::EQU:
+	case OpCode::GTE:
+	case OpCode::GT:
+	case OpCode::NEQ:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+/********************************************************************************************//**
+ * @param	op		A binary stack machine operation
+ * @param	branch	Return the conditional jump, rather than the comparison, if true
+ * @return	The register operation for op
+ ************************************************************************************************/
+RegOp RegTranslator::regOp(OpCode op, bool branch) {
+	switch(op) {
+	case OpCode::ADD:	return RegOp::ADD;
+	case OpCode::SUB:	return RegOp::SUB;
+	case OpCode::MUL:	return RegOp::MUL;
+	case OpCode::DIV:	return RegOp::DIV;
+	case OpCode::REM:	return RegOp::REM;
+	case OpCode::LT:	return branch ? RegOp::JNLT : RegOp::LT;
+	case OpCode::LTE:	return branch ? RegOp::JNLTE : RegOp::LTE;
+	case OpCode::EQU:	return branch ? RegOp::JNEQU : RegOp::EQU;
+	case OpCode::GTE:	return branch ? RegOp::JNGTE : RegOp::GTE;
+	case OpCode::GT:	return branch ? RegOp::JNGT : RegOp::GT;
+	case OpCode::NEQ:	return branch ? RegOp::JNNEQ : RegOp::NEQ;
+	default:			assert(false); return RegOp::STACK;
+	}
+}
+
+// private
+
+/********************************************************************************************//**
+ * Variable values are pushed with a single move, rather than pushvar and eval.
+ *
+ * @param	entry	The entry to push
+ ************************************************************************************************/
+void RegTranslator::push(const Entry& entry) {
+	switch(entry.kind) {
+	case Entry::Const:
+	case Entry::Addr:
+		rcode->push_back(RegInstr(entry.instr, entry.addr));
+		break;
+
+	case Entry::Var: {
+		RegInstr ri(RegOp::MOVE, entry.instr, entry.addr);
+		ri.dst = Operand(Operand::Stack);
+		ri.lhs = entry.lhs;
+		rcode->push_back(ri);
+		break;
+	}
+
+	case Entry::Temp: {
+		RegInstr ri(regOp(entry.instr.op, false), entry.instr, entry.addr);
+		ri.dst = Operand(Operand::Stack);
+		ri.lhs = entry.lhs;
+		ri.rhs = entry.rhs;
+		rcode->push_back(ri);
+		break;
+	}
+	}
+}
+
+/********************************************************************************************//**
+ * @param	n	The number of entries, from the bottom of the symbolic stack, to materialize
+ ************************************************************************************************/
+void RegTranslator::materialize(size_t n) {
+	for (size_t i = 0; i < n; ++i)
+		push(stack[i]);
+
+	stack.erase(stack.begin(), stack.begin() + n);
+}
+
+/********************************************************************************************//**
+ * @param	instr	The instruction
+ * @param	addr	instr's address
+ ************************************************************************************************/
+void RegTranslator::generic(const Instr& instr, uint32_t addr) {
+	materialize(stack.size());
+	rcode->push_back(RegInstr(instr, addr));
+}
+
+/********************************************************************************************//**
+ * The right hand operand must be a constant or a variable. The left hand operand is used in
+ * place if it's also a constant or variable, but not if both are constants, as an instruction
+ * only has room for one constant, otherwise it's popped.
+ *
+ * @param	instr	The instruction
+ * @param	addr	instr's address
+ ************************************************************************************************/
+void RegTranslator::translateBinary(const Instr& instr, uint32_t addr) {
+	const size_t n = stack.size();
+	if (n == 0 || (stack[n-1].kind != Entry::Const && stack[n-1].kind != Entry::Var)) {
+		generic(instr, addr);
+		return;
+	}
+
+	const Entry rhs = stack[n-1];
+	Entry temp { Entry::Temp, Operand(), rhs.lhs, Instr(instr.op), addr };
+	if (rhs.kind == Entry::Const)
+		temp.instr.value = rhs.instr.value;
+
+	const Entry* lhs = n >= 2 ? &stack[n-2] : nullptr;
+	if (lhs != nullptr && (lhs->kind == Entry::Var
+			|| (lhs->kind == Entry::Const && rhs.kind != Entry::Const))) {
+		temp.lhs = lhs->lhs;
+		if (lhs->kind == Entry::Const)
+			temp.instr.value = lhs->instr.value;
+		stack.resize(n - 2);
+
+	} else {
+		materialize(n - 1);
+		temp.lhs = Operand(Operand::Stack);
+		stack.clear();
+	}
+
+	stack.push_back(temp);
+}
+
+/********************************************************************************************//**
+ * Single Datum assignments of a constant, variable, or binary operation, to a variable, become
+ * a single move, or binary operation, to the variable's frame slot.
+ *
+ * @param	instr	The instruction
+ * @param	addr	instr's address
+ ************************************************************************************************/
+void RegTranslator::translateAssign(const Instr& instr, uint32_t addr) {
+	const size_t n = stack.size();
+	if (instr.value.kind() != Datum::Integer || instr.value.integer() != 1 || n < 2
+			|| stack[n-2].kind != Entry::Addr || stack[n-1].kind == Entry::Addr
+			|| (stack[n-1].kind == Entry::Temp && stack[n-1].lhs.mode == Operand::Stack)) {
+		generic(instr, addr);
+		return;
+	}
+
+	materialize(n - 2);						// Earlier loads must preceed the store
+	const Operand dst = stack[0].lhs;
+	const Entry& value = stack[1];
+
+	if (value.kind == Entry::Temp) {
+		RegInstr ri(regOp(value.instr.op, false), value.instr, value.addr);
+		ri.dst = dst;
+		ri.lhs = value.lhs;
+		ri.rhs = value.rhs;
+		rcode->push_back(ri);
+
+	} else {
+		RegInstr ri(RegOp::MOVE, value.instr, addr);
+		ri.dst = dst;
+		ri.lhs = value.lhs;
+		rcode->push_back(ri);
+	}
+
+	stack.clear();
+}
+
+/********************************************************************************************//**
+ * A jump on the result of a comparison becomes a single compare and jump.
+ *
+ * @param	instr	The instruction
+ * @param	addr	instr's address
+ ************************************************************************************************/
+void RegTranslator::translateJneqi(const Instr& instr, uint32_t addr) {
+	const size_t n = stack.size();
+	if (n == 0 || stack[n-1].kind != Entry::Temp
+			|| regOp(stack[n-1].instr.op, true) == regOp(stack[n-1].instr.op, false)) {
+		generic(instr, addr);
+		return;
+	}
+
+	materialize(n - 1);
+	const Entry& cond = stack[0];
+	RegInstr ri(regOp(cond.instr.op, true), cond.instr, cond.addr);
+	ri.lhs = cond.lhs;
+	ri.rhs = cond.rhs;
+	ri.target = instr.value.natural();
+	rcode->push_back(ri);
+
+	stack.clear();
+}
+
+/********************************************************************************************//**
+ * The block's line numbers are the stack machine addresses of it's instructions.
+ *
+ * @param	block	The block to translate
+ ************************************************************************************************/
+void RegTranslator::translate(const CFG::Block& block) {
+	for (size_t i = 0; i < block.code.size(); ++i) {
+		const Instr& instr = block.code[i];
+		const uint32_t addr = block.lines[i];
+
+		switch(instr.op) {
+		case OpCode::PUSH:
+			stack.push_back(Entry { Entry::Const, Operand(Operand::Const), Operand(), instr, addr });
+			break;
+
+		case OpCode::PUSHVAR:
+			stack.push_back(Entry { Entry::Addr,
+				Operand(Operand::Frame, instr.level, instr.value.integer()), Operand(), instr, addr });
+			break;
+
+		case OpCode::EVAL:
+			if (!stack.empty() && stack.back().kind == Entry::Addr
+					&& instr.value.kind() == Datum::Integer && instr.value.integer() == 1)
+				stack.back().kind = Entry::Var;
+			else
+				generic(instr, addr);
+			break;
+
+		case OpCode::ASSIGN:
+			translateAssign(instr, addr);
+			break;
+
+		case OpCode::JNEQI:
+			translateJneqi(instr, addr);
+			break;
+
+		default:
+			if (binary(instr.op))
+				translateBinary(instr, addr);
+			else
+				generic(instr, addr);
+		}
+	}
+
+	materialize(stack.size());
+}
+
+// public
+
+/********************************************************************************************//**
+ * Code that can't be represented as a CFG, e.g., uses computed addresses, can't be translated.
+ *
+ * @param	code	The stack machine code
+ * @param	rcode	The translated code
+ *
+ * @return	false if code couldn't be translated
+ ************************************************************************************************/
+bool RegTranslator::operator()(const InstrVector& code, RegInstrVector& rcode) {
+	CFG::SourceIndex addrs(code.size());	// Track each instruction's address as it's line
+	for (size_t pc = 0; pc < code.size(); ++pc)
+		addrs[pc] = pc;
+
+	CFG cfg;
+	if (!cfg.build(code, addrs))
+		return false;
+
+	rcode.clear();
+	this->rcode = &rcode;
+	stack.clear();
+
+	const CFG::BlockVec& blocks = cfg.blocks();
+	vector<uint32_t> start(blocks.size());
+	for (size_t b = 0; b < blocks.size(); ++b) {
+		start[b] = rcode.size();
+		translate(blocks[b]);
+	}
+
+	for (auto& ri : rcode) {				// Relocate block numbers to addresses
+		if (ri.op == RegOp::STACK && CFG::isBranch(ri.instr.op))
+			ri.instr.value = start[ri.instr.value.natural()];
+
+		else if (ri.op >= RegOp::JNLT)
+			ri.target = start[ri.target];
+	}
+
+	return true;
+}
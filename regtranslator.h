@@ -0,0 +1,80 @@
+/********************************************************************************************//**
+ * @file regtranslator.h
+ *
+ * class RegTranslator, translates stack machine code into register machine code.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	REGTRANSLATOR_H
+#define	REGTRANSLATOR_H
+
+#include <vector>
+
+#include "cfg.h"
+#include "reginstr.h"
+
+/********************************************************************************************//**
+ * Stack to register code translator
+ *
+ * Translates each basic block by simulating the evaluation stack; pushes of constants, variable
+ * addresses and variable values, and binary operations on them, are deferred on a symbolic
+ * stack, and folded into the instruction that consumes them. Thus "x := y + z" becomes a single
+ * "add [x], [y], [z]", and "while i < n" a single "jnlt [i], [n], exit". Deferred entries are
+ * materialized, bottom up, on the real stack when an instruction can't use them, and before the
+ * end of each block, so the stack is the same as the stack machine's at every block boundary.
+ *
+ * Loads are only deferred past stores to other variables; a store first materializes any
+ * deferred entries below it.
+ ************************************************************************************************/
+class RegTranslator {
+public:
+	/// Translate code into rcode...
+	bool operator()(const InstrVector& code, RegInstrVector& rcode);
+
+private:
+	/// A symbolic stack entry
+	struct Entry {
+		/// Entry kinds
+		enum Kind {
+			Const,							///< A constant, value
+			Addr,							///< A variable address, base(level) + offset
+			Var,							///< A variable's value
+			Temp							///< The result of op lhs, rhs
+		};
+
+		Kind		kind;					///< What is it?
+		Operand		lhs;					///< Const, Addr, Var: the operand; Temp: lhs
+		Operand		rhs;					///< Temp: the right hand operand
+		Instr		instr;					///< The stack instruction, and it's constant, if any
+		uint32_t	addr;					///< instr's address
+	};
+
+	RegInstrVector*		rcode;				///< The translated code
+	std::vector<Entry>	stack;				///< Deferred entries; the top of the real stack
+
+	/// Is op a translated binary operation?
+	static bool binary(OpCode op);
+
+	/// Return the register operation for op...
+	static RegOp regOp(OpCode op, bool branch);
+
+	void push(const Entry& entry);			///< Emit code that pushes entry...
+	void materialize(size_t n);				///< Materialize the bottom n deferred entries...
+	void generic(const Instr& instr, uint32_t addr); ///< Emit a stack machine instruction...
+
+	/// Translate a binary operation...
+	void translateBinary(const Instr& instr, uint32_t addr);
+
+	/// Translate an assignment...
+	void translateAssign(const Instr& instr, uint32_t addr);
+
+	/// Translate a conditional jump...
+	void translateJneqi(const Instr& instr, uint32_t addr);
+
+	/// Translate a basic block...
+	void translate(const CFG::Block& block);
+};
+
+#endif
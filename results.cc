@@ -33,6 +33,7 @@ ostream& operator<<(std::ostream& os, const Result result) {
 	case Result::freeStoreError:	os << "free-store error";		break;
 	case Result::outOfRange:		os << "out-of-range";			break;
 	case Result::illegalOp:			os << "illegal operation";		break;
+	case Result::compileError:		os << "compile error";			break;
 	case Result::halted:			os << "halted";					break;
 	default:
 		return os << "undefined result!";
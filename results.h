@@ -27,6 +27,7 @@ enum class Result {
 	freeStoreError,							///< Allocation or free error
 	outOfRange,								///< Attempt to index object with out-of-range index
 	illegalOp,								///< Illegal operation
+	compileError,							///< A deferred subroutine failed to compile
 	halted									///< Machine has halted
 };
 
@@ -0,0 +1,55 @@
+/********************************************************************************************//**
+ * @file runtime.cc
+ *
+ * class PRuntime implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "runtime.h"
+
+using namespace std;
+
+/************************************************************************************************
+ * class PRuntime
+ ************************************************************************************************/
+
+// public
+
+/********************************************************************************************//**
+ * @param	code	The program's code table
+ * @param	size	The number of instructions in code
+ ************************************************************************************************/
+PRuntime::PRuntime(const Instr* code, size_t size) {
+	this->code = code;
+	codeSize = size;
+}
+
+/********************************************************************************************//**
+ * Errors are reported as the interpreter reports them.
+ *
+ * @param	program	The translated procedure at address 0
+ * @return	Result::success, or ...
+ ************************************************************************************************/
+Result PRuntime::operator()(Procedure program) {
+	reset();
+
+	Result status = Result::success;
+	try {
+		program(*this);
+
+	} catch (const Stop& stop) {
+		status = stop.result;
+
+	} catch (Result result) {
+		cerr << result << " @pc " << prevPc << ", sp: " << sp << endl;
+		status = result;
+	}
+
+	if (status != Result::success && status != Result::halted)
+		cerr << "runtime error @pc " << prevPc << ", sp: " << sp << ": " << status << endl;
+
+	output.drain();							// The output precedes anything written after the run
+	return Result::halted == status ? Result::success : status;
+}
@@ -0,0 +1,190 @@
+/********************************************************************************************//**
+ * @file runtime.h
+ *
+ * class PRuntime, the run time support for P programs translated to C++.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	RUNTIME_H
+#define	RUNTIME_H
+
+#include <cstdint>
+
+#include "interp.h"
+
+/********************************************************************************************//**
+ * The P machine, for translated programs
+ *
+ * Translated programs are C++ functions, one per procedure, that run on the machine's stack and
+ * registers; control flow is C++ control flow, and each instruction is a call of one of the
+ * methods below, passing the instruction's address in the program's code table. Integer
+ * operands, and variable loads and stores, are handled inline; anything else, including any
+ * instruction that would fail, is executed by the machine, so results, and errors, are the same
+ * as the interpreter's.
+ ************************************************************************************************/
+class PRuntime : public PInterp {
+public:
+	typedef void (*Procedure)(PRuntime& machine);	///< A translated procedure
+
+	/// Construct a machine for code...
+	PRuntime(const Instr* code, size_t size);
+
+	/// Run program, the translated program entry...
+	Result operator()(Procedure program);
+
+	/// Execute the instruction at addr...
+	void exec(uint32_t addr) {
+		pc = addr;
+		const Result r = step();
+		if (Result::success != r)
+			throw Stop { r };
+	}
+
+	/// Execute the jump at addr, returning true if it was taken
+	bool branch(uint32_t addr) {
+		exec(addr);
+		return pc != addr + 1;
+	}
+
+	/// PUSH
+	void push(uint32_t addr) {
+		prevPc = addr;
+		if (sp < 1)
+			exec(addr);
+		else
+			PInterp::push(code[addr].value);
+	}
+
+	/// PUSHVAR level, offset
+	void pushvar(uint32_t addr, int8_t level, int offset) {
+		prevPc = addr;
+		if (sp < 1)
+			exec(addr);
+		else
+			PInterp::push(base(level) + offset);
+	}
+
+	/// EVAL 1
+	void eval(uint32_t addr) {
+		prevPc = addr;
+		if (sp < 1 || sp > heap.addr() || stack[sp].kind() != Datum::Integer || stack[sp].integer() < 0
+				|| static_cast<size_t>(stack[sp].integer()) >= sp)
+			exec(addr);
+		else
+			stack[sp] = stack[stack[sp].integer()];
+	}
+
+	/// ASSIGN 1
+	void assign(uint32_t addr) {
+		prevPc = addr;
+		if (sp < 2 || stack[sp - 1].kind() != Datum::Integer || stack[sp - 1].integer() < 0
+				|| static_cast<size_t>(stack[sp - 1].integer()) > sp)
+			exec(addr);
+
+		else {
+			stack[stack[sp - 1].integer()] = stack[sp];
+			sp -= 2;
+		}
+	}
+
+	/// ADD, SUB, MUL, DIV or REM
+	void arith(uint32_t addr, OpCode op) {
+		prevPc = addr;
+		if (!integers() || ((op == OpCode::DIV || op == OpCode::REM) && !divisor()))
+			exec(addr);
+
+		else {
+			const int b = stack[sp--].integer();
+			Datum& a = stack[sp];
+			switch(op) {
+			case OpCode::ADD:	a = a.integer() + b;	break;
+			case OpCode::SUB:	a = a.integer() - b;	break;
+			case OpCode::MUL:	a = a.integer() * b;	break;
+			case OpCode::DIV:	a = a.integer() / b;	break;
+			default:			a = a.integer() % b;	break;
+			}
+		}
+	}
+
+	/// LT, LTE, EQU, GTE, GT or NEQ
+	void compare(uint32_t addr, OpCode op) {
+		prevPc = addr;
+		if (!integers())
+			exec(addr);
+
+		else {
+			const int b = stack[sp--].integer();
+			stack[sp] = test(op, stack[sp].integer(), b);
+		}
+	}
+
+	/// A comparison, followed by a JNEQI; returns true if the jump is taken
+	bool jump(uint32_t addr, OpCode op) {
+		prevPc = addr;
+		if (!integers()) {
+			exec(addr);
+			return jneqi(addr + 1);
+		}
+
+		sp -= 2;
+		return !test(op, stack[sp + 1].integer(), stack[sp + 2].integer());
+	}
+
+	/// JNEQI; returns true if the jump is taken
+	bool jneqi(uint32_t addr) {
+		if (sp < 1 || stack[sp].kind() != Datum::Boolean)
+			return branch(addr);
+
+		return !stack[sp--].boolean();
+	}
+
+	/// FORNEXT inc; returns true if the jump is taken
+	bool fornext(uint32_t addr, int8_t inc) {
+		prevPc = addr;
+		if (sp < 2 || stack[sp].kind() != Datum::Integer || stack[sp - 1].kind() != Datum::Integer
+				|| stack[sp - 1].integer() < 0 || static_cast<size_t>(stack[sp - 1].integer()) > sp
+				|| stack[stack[sp - 1].integer()].kind() != Datum::Integer)
+			return branch(addr);
+
+		const int last = stack[sp].integer();
+		Datum& value = stack[stack[sp - 1].integer()];
+		if (inc > 0 ? value.integer() < last : last < value.integer()) {
+			value = value.integer() + inc;
+			return true;
+		}
+
+		sp -= 2;
+		return false;
+	}
+
+private:
+	/// Thrown when an instruction fails, or the machine halts
+	struct Stop {
+		Result		result;					///< Why
+	};
+
+	/// Are TOS and TOS-1 Integers, that may be replaced by a result?
+	bool integers() const {
+		return sp >= 2 && sp <= heap.addr()
+			&& stack[sp].kind() == Datum::Integer && stack[sp - 1].kind() == Datum::Integer;
+	}
+
+	/// Is TOS a divisor that can't fail, or trap?
+	bool divisor() const					{	return stack[sp].integer() != 0 && stack[sp].integer() != -1;	}
+
+	/// Return a op b
+	static bool test(OpCode op, int a, int b) {
+		switch(op) {
+		case OpCode::LT:	return a < b;
+		case OpCode::LTE:	return a <= b;
+		case OpCode::EQU:	return a == b;
+		case OpCode::GTE:	return a >= b;
+		case OpCode::GT:	return a > b;
+		default:			return a != b;
+		}
+	}
+};
+
+#endif
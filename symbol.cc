@@ -153,6 +153,100 @@ TDescPtrVec& SymValue::params() 					{   return _params;			}
  ************************************************************************************************/
 const TDescPtrVec& SymValue::params() const 		{   return _params;			}
 
+/************************************************************************************************
+ * class SymbolTable
+ ************************************************************************************************/
+
+// public
+
+/********************************************************************************************//**
+ * The new binding is placed above any bindings at a lower block level, but below any others
+ * at the same level, so that the first of duplicate declarations remains the closest.
+ *
+ * @param	entry	The identifier and it's value
+ * @return	An iterator positioned at the new entry
+ ************************************************************************************************/
+SymbolTable::iterator SymbolTable::insert(const value_type& entry) {
+	const int level = entry.second.level();
+	auto it = entries.insert(entries.end(), entry);
+	++nInserted;
+
+	if (bindings.size() <= entry.first.id())
+		bindings.resize(entry.first.id() + 1);
+
+	Bindings& stack = bindings[entry.first.id()];
+	auto pos = stack.end();
+	while (pos != stack.begin() && (*(pos - 1))->second.level() >= level)
+		--pos;
+	stack.insert(pos, it);
+
+	if (scopes.size() <= static_cast<size_t>(level))
+		scopes.resize(level + 1);
+	scopes[level].push_back(it);
+
+	return it;
+}
+
+/********************************************************************************************//**
+ * @param	id	The identifier to look up
+ * @return	end(), or the binding of id with the highest block level.
+ ************************************************************************************************/
+SymbolTable::iterator SymbolTable::find(Atom id) {
+	if (id.id() >= bindings.size() || bindings[id.id()].empty())
+		return entries.end();
+	return bindings[id.id()].back();
+}
+
+/********************************************************************************************//**
+ * @param	id		The identifier to look up
+ * @param	level	The block level
+ * @return	true if id has a binding declared at level
+ ************************************************************************************************/
+bool SymbolTable::defined(Atom id, int level) const {
+	if (id.id() < bindings.size()) {
+		const Bindings& stack = bindings[id.id()];
+		for (auto b = stack.rbegin(); b != stack.rend() && (*b)->second.level() >= level; ++b)
+			if ((*b)->second.level() == level)
+				return true;
+	}
+
+	return false;
+}
+
+/********************************************************************************************//**
+ * @param	level	The block level
+ * @return	The entries declared at level, in order of declaration
+ ************************************************************************************************/
+const std::vector<SymbolTable::iterator>& SymbolTable::scope(int level) const {
+	static const vector<iterator> empty;
+	return static_cast<size_t>(level) < scopes.size() ? scopes[level] : empty;
+}
+
+/********************************************************************************************//**
+ * Entries are removed in reverse order of declaration, thus each entry's binding is normally at
+ * the top of it's identifier's stack.
+ *
+ * @param	level	The block level
+ ************************************************************************************************/
+void SymbolTable::purge(int level) {
+	if (static_cast<size_t>(level) >= scopes.size())
+		return;
+
+	auto& log = scopes[level];
+	for (auto it = log.rbegin(); it != log.rend(); ++it) {
+		Bindings& stack = bindings[(*it)->first.id()];
+		for (auto pos = stack.end(); pos != stack.begin(); )
+			if (*--pos == *it) {
+				stack.erase(pos);
+				break;
+			}
+
+		entries.erase(*it);
+	}
+
+	log.clear();
+}
+
 // operators
 
 /********************************************************************************************//**
@@ -10,9 +10,11 @@
 #ifndef SYMBOL_H
 #define SYMBOL_H
 
-#include <map>
+#include <list>
 #include <sstream>
+#include <vector>
 
+#include "atom.h"
 #include "datum.h"
 #include "type.h"
 
@@ -79,9 +81,42 @@ private:
 std::ostream& operator<<(std::ostream& os, const SymValue::Kind& kind);
 
 /********************************************************************************************//**
- * A SymbolTable; a multimap of symbol identifiers to SymValue's
+ * A SymbolTable; a scoped map of symbol identifiers to SymValue's
+ *
+ * Each identifier atom indexes a stack of bindings, ordered by block level, so the closest
+ * binding is at the top. Each block level keeps an undo log of the entries declared at that
+ * level, thus purging a level only visits the entries that were declared in it. Entries live in
+ * a list, so iterators, and pointers to values, remain valid until the entry is purged.
  ************************************************************************************************/
-typedef std::multimap<std::string, SymValue> SymbolTable;
+class SymbolTable {
+public:
+	typedef std::pair<const Atom, SymValue>			value_type;	///< An entry
+	typedef std::list<value_type>::iterator			iterator;	///< An entry iterator
+
+	iterator insert(const value_type& entry);	///< Insert entry...
+	iterator find(Atom id);						///< Return id's closest binding...
+	bool defined(Atom id, int level) const;		///< Is id defined at level?
+
+	/// Return the entries declared at level...
+	const std::vector<iterator>& scope(int level) const;
+
+	void purge(int level);						///< Remove the entries declared at level...
+
+	iterator end()								{	return entries.end();	}
+	size_t size() const							{	return entries.size();	}
+
+	/// Return the number of entries ever inserted
+	size_t inserted() const						{	return nInserted;		}
+
+private:
+	/// Bindings of an identifier, by ascending block level
+	typedef std::vector<iterator> Bindings;
+
+	std::list<value_type>						entries;	///< The entries
+	std::vector<Bindings>						bindings;	///< Bindings, indexed by atom id
+	std::vector<std::vector<iterator>>			scopes;		///< Undo log, indexed by level
+	size_t										nInserted { 0 };	///< Entries ever inserted
+};
 
 /********************************************************************************************//**
  * A SymbolTable iterator
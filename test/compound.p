@@ -0,0 +1,31 @@
+{ Compound assignments; in place updates, and limit checked updates of subrange variables }
+program compound() is
+type
+	Small is 0..100;
+var
+	i, n : integer;
+	s : Small;
+	x : real;
+	r : record count : array [1..4] of integer end;
+begin
+	n := 0;
+	for i in 1..4 loop r.count[i] := 0 endloop;
+	for i in 1..10 loop
+		n += i;
+		r.count[(i mod 4) + 1] += 1
+	endloop;
+	n -= 5;
+	n *= 2;
+	n /= 3;
+	s := 10;
+	s += 5;
+	s *= 2;
+	x := 1.5;
+	x += 1;
+	x *= 2.0;
+	x /= 4;
+	x -= 0.25;
+	putln(n); putln(s); putln(x);
+	putln(r.count[1]); putln(r.count[2]); putln(r.count[3]); putln(r.count[4]);
+	s *= 10
+endprog
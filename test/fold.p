@@ -0,0 +1,43 @@
+{ Test compile-time folding of constant (sub-)expressions }
+program Fold() is
+type
+	Row is array [1..3] of integer;
+	P is record
+		x, y : integer
+	end;
+
+var
+	i : integer;
+	c : character;
+	m : array [0..1] of Row;
+	ps : array [1..2] of P;
+
+begin
+	putln(2 * (3 + 4));				{ 14				}
+	putln(sqr(3) + abs(-4));		{ 13				}
+	putln(ord('A') + 1);			{ 66				}
+	putln(not (1 > 2));				{ true				}
+	putln(7 mod 3 = 1);				{ true				}
+
+	m[0, 1] := 1;
+	m[0, 1 + 2] := 3;
+	m[1, 1] := 4;
+	i := 2;
+	m[1, i] := 5;
+	m[0, i] := m[1, i] - 3;
+	putln(m[0]);					{ 1 2 3				}
+	putln(m[1, 1] + m[1, 2]);		{ 9					}
+
+	ps[2].x := 6;
+	ps[2].y := 7;
+	ps[1].x := ps[2].y - ps[2].x;
+	putln(ps[1].x);					{ 1					}
+	putln(ps[2].y);					{ 7					}
+
+	c := 'z';
+	putln(ord(c) - ord('a'));		{ 25, as ord('z') - ord('a') }
+
+	i := 1;
+	putln(i * (10 / 2));			{ 5					}
+	putln(1 / (i - 1))			{ runtime error		}
+endprog
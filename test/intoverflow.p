@@ -0,0 +1,8 @@
+{ Integer literals that exceed an Integer are errors, rather than clamped }
+program intoverflow() is
+const big = 3000000000;
+
+begin
+	putln(2147483647);
+	putln(2147483648)
+endprog
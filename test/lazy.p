@@ -0,0 +1,40 @@
+{ Subroutines, compiled when first called with --lazy, including one never called }
+program lazy() is
+const n = 5;
+var total : integer;
+
+function fib(i : integer) : integer is
+	begin
+		if i < 2 then
+			return i
+		else
+			return fib(i - 1) + fib(i - 2)
+		endif
+	endfunc
+
+procedure count(i : integer) is
+	procedure add(j : integer) is
+		begin
+			total := total + j
+		endproc
+
+	begin
+		if i > 0 then
+			add(i);
+			count(i - 1)
+		endif
+	endproc
+
+procedure unused() is
+	begin
+		putln(-1)
+	endproc
+
+begin
+	total := 0;
+	count(n);
+	putln(total);
+	count(n);
+	putln(total);
+	putln(fib(n * 2))
+endprog
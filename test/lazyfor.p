@@ -0,0 +1,17 @@
+{ A for-loop iterator written by a subroutine, compiled after the loop with --lazy, isn't known }
+
+program lazyfor() is
+var i : integer;
+	a : array[1..3] of integer;
+
+	procedure p() is
+	begin
+		i := 5
+	endproc
+
+begin
+	for i in 1..3 loop
+		p();
+		a[i] := 42
+	endloop
+endprog
@@ -0,0 +1,42 @@
+{ put and putln widths and precisions, of each kind of value }
+program putformat() is
+type
+	R is record
+		c : character;
+		i : integer
+	end;
+
+var
+	s : array [1..5] of character;
+	a : array [1..3] of integer;
+	x : array [1..2] of real;
+	r : R;
+	i : integer;
+
+begin
+	s := "hello";
+	a[1] := -12; a[2] := 0; a[3] := 345;
+	x[1] := 1.5; x[2] := -0.25;
+	r.c := 'z'; r.i := -7;
+
+	putln(s);
+	putln(s, 3);
+	putln(a);
+	putln(a, 5);
+	putln(x);
+	putln(x, 10, 2);
+	putln(r);
+	putln(true);
+	putln(false, 10);
+	putln('c', 4);
+	putln(-2147483647 - 1);
+	putln(42, 6);
+	putln(-42, -6);
+	putln(3.14159);
+	putln(3.14159, 12);
+	putln(3.14159, 12, 3);
+	putln(-3.14159, 0, 9);
+	putln(1.0e300, 0, 1);
+	for i in 1..3 loop put(i, 3) endloop;
+	putln()
+endprog
@@ -0,0 +1,32 @@
+{ Test limit check elimination via range analysis }
+program RangeTest() is
+type
+	R is 0..4;
+
+var
+	i : integer;
+	r : R;
+	a : array [R] of integer;
+	m : array [R] of array [R] of integer;
+
+begin
+	for i in R loop					{ no index checks			}
+		a[i] := i * 2
+	endloop;
+	putln(a);						{ [0,2,4,6,8]				}
+
+	for r in R loop					{ no index checks			}
+		for i in R loop
+			m[r, i] := r + i
+		endloop
+	endloop;
+	putln(m[4]);					{ [4,5,6,7,8]				}
+
+	r := 3;
+	a[r] := a[r + 1];				{ upper limit check only	}
+	putln(a[r]);					{ 8							}
+
+	for r in 2..6 loop				{ out-of-range at 5			}
+		putln(r)
+	endloop
+endprog
@@ -0,0 +1,50 @@
+{ Short-circuit and/or evaluation	}
+program ShortCircuit() is
+var
+	a : array [1..5] of integer;
+	i : integer;
+	b : boolean;
+
+function noisy(v : boolean) : boolean is
+	begin
+		putln("noisy");
+		return v
+	endfunc
+
+begin
+	a[1] := 3; a[2] := 1; a[3] := 4; a[4] := 1; a[5] := 5;
+
+	b := false and noisy(true);			{ false, no noise			}
+	putln(b);
+	b := true or noisy(false);			{ true, no noise			}
+	putln(b);
+	b := (1 = 1) and noisy(true);		{ noisy, true				}
+	putln(b);
+	b := (1 = 2) or noisy(false) or (2 = 2);	{ noisy, true		}
+	putln(b);
+	b := not ((1 = 1) and (2 = 3));		{ true						}
+	putln(b);
+
+	i := 1;								{ search for 4				}
+	while (i <= 5) and (a[i] <> 4) loop
+		i := i + 1
+	endloop;
+	putln(i);							{ 3							}
+
+	if (i = 1) or (i = 2) or (i = 3) then
+		putln("1, 2 or 3")
+	elif ((i > 3) or noisy(false)) and noisy(true) then
+		putln("unreachable")
+	else
+		putln("else")
+	endif;
+
+	if (i = 9) and noisy(true) then		{ no noise					}
+		putln("unreachable")
+	endif;
+
+	repeat
+		i := i + 1
+	until (i = 5) or (i > 9) endloop;
+	putln(i)							{ 5							}
+endprog
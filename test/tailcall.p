@@ -0,0 +1,45 @@
+{ Tail calls reuse the caller's frame, so these recursions run in constant stack }
+
+program tailcall() is
+	{ Count down from n, recursively }
+	procedure countdown(n : integer) is
+	begin
+		if n > 0 then
+			countdown(n - 1)
+		endif
+	endproc
+
+	{ Sum 1..n, accumulating the sum in acc }
+	function sum(n, acc : integer) : integer is
+	begin
+		if n = 0 then
+			return acc
+		endif;
+		return sum(n - 1, acc + n)
+	endfunc
+
+	{ Is n even? odds is nested within evens, so only odds' calls are tail calls }
+	procedure evens(n : integer) is
+		procedure odds(n : integer) is
+		begin
+			if n > 0 then
+				evens(n - 1)
+			else
+				putln(false)
+			endif
+		endproc
+
+	begin
+		if n > 0 then
+			odds(n - 1)
+		else
+			putln(true)
+		endif
+	endproc
+
+begin
+	countdown(100000);
+	putln(sum(10000, 0));
+	evens(20);
+	evens(21)
+endprog
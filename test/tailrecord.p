@@ -0,0 +1,40 @@
+{ Calls passing, or from subroutines taking, records aren't tail calls, as SLIDE moves Datums }
+
+program tailrecord() is
+type
+	Pair is record
+		a, b : integer
+	end;
+
+var q : Pair;
+
+	procedure show(p : Pair; n : integer) is
+	begin
+		putln(p.a + p.b + n)
+	endproc
+
+	procedure go(n : integer) is
+	var r : Pair;
+	begin
+		r.a := 10;
+		r.b := 5;
+		show(r, n)
+	endproc
+
+	procedure again(p : Pair; n : integer) is
+	begin
+		show(p, n + 1)
+	endproc
+
+	procedure last(p : Pair) is
+	begin
+		go(p.a)
+	endproc
+
+begin
+	go(5);
+	q.a := 1;
+	q.b := 2;
+	again(q, 3);
+	last(q)
+endprog
@@ -0,0 +1,25 @@
+{ A variable's declared range is trusted only once it's known to have been assigned }
+
+program uninit() is
+var r : 5..9;
+	s : 5..9;
+	a : array[5..9] of integer;
+	e : array[1..3] of 5..9;
+	q : record x, y : 5..9 end;
+	b, c : array[5..9] of integer;
+
+begin
+	s := 7;
+	a[s] := 42;
+	putln(a[s]);
+	if s = 5 then
+		r := 6
+	endif;
+
+	{ Assigning an element, or field, doesn't assign the whole array, or record }
+	e[1] := 7;
+	q.x := 6;
+	c[q.y] := 43;					{ runtime error, and the following are checked }
+	b[e[2]] := 42;
+	a[r] := 77
+endprog
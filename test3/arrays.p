@@ -0,0 +1,20 @@
+{ Array loops; lower bounds, and constant offsets, are folded into the array's reference }
+program arrays() is
+var
+	i, k : integer;
+	a, b : array [1..10] of integer;
+	r : array [1..10] of record x, y : integer end;
+begin
+	k := 3;
+	for i in 1..10 loop
+		b[i] := i
+	endloop;
+	for i in 1..10 loop
+		a[i] := b[i] * k
+	endloop;
+	for i in 1..10 loop
+		r[i].y := a[i]
+	endloop;
+	putln(a[10]);
+	putln(r[5].y)
+endprog
@@ -0,0 +1,31 @@
+{ Control flow passes; jump threading and block merging, compiled with -O2 }
+program blocks() is
+var
+	i, n : integer;
+begin
+	i := 0;
+	n := 0;
+	while i < 10 loop
+		if i < 3 then
+			if i = 1 then
+				n := n + 1
+			else
+				n := n + 2
+			endif
+		elif i < 6 then
+			n := n + 10
+		else
+			n := n + 100
+		endif;
+		i := i + 1
+	endloop;
+	putln(n);
+
+	repeat
+		i := i - 1;
+		if i = 5 then
+			putln(i)
+		endif
+	until i = 0 endloop;
+	putln(i)
+endprog
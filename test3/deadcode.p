@@ -0,0 +1,37 @@
+{ Unreachable code; uncalled subroutines, code following a return, and constant conditions }
+program deadcode() is
+var
+	i, n : integer;
+
+	procedure unused(k : integer) is
+	begin
+		putln(k)
+	endproc
+
+	function twice(k : integer) : integer is
+	begin
+		return k * 2;
+		putln(k)
+	endfunc
+
+	function odds(k : integer) : integer is
+	var j, s : integer;
+	begin
+		s := 0;
+		j := 1;
+		while j <= k loop
+			if j mod 2 = 1 then s := s + j endif;
+			j := j + 1
+		endloop;
+		return s
+	endfunc
+begin
+	n := 0;
+	for i in 1..10 loop
+		n := n + twice(i)
+	endloop;
+	if false then putln(0) endif;
+	if true then putln(n) else putln(1) endif;
+	while false loop putln(2) endloop;
+	putln(odds(9))
+endprog
@@ -0,0 +1,62 @@
+{ Procedure inlining, compiled with -O2 }
+program inline() is
+var
+	i, j, k : integer;
+	a : array [1..4] of integer;
+
+	function max(x, y : integer) : integer is
+	begin
+		if x > y then
+			return x
+		else
+			return y
+		endif
+	endfunc
+
+	function min(x, y : integer) : integer is
+	begin
+		if x < y then return x endif;
+		return y
+	endfunc
+
+	procedure order(a, b : integer; var lo, hi : integer) is
+	begin
+		if a < b then
+			lo := a;
+			hi := b
+		else
+			lo := b;
+			hi := a
+		endif
+	endproc
+
+	function at(n : integer) : integer is
+	begin
+		return a[n]
+	endfunc
+
+	procedure show(n : integer) is
+	begin
+		putln(n)
+	endproc
+
+begin
+	i := 3;
+	j := 7;
+	putln(max(i, j));
+	putln(min(i, j));
+	order(j, i, i, j);
+	putln(i);
+	putln(j);
+	putln(max(min(i, j), 5));
+
+	for k in 1..4 loop
+		a[k] := k * k
+	endloop;
+
+	k := 0;
+	for i in 1..4 loop
+		k := k + at(i)
+	endloop;
+	show(k)
+endprog
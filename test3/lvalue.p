@@ -0,0 +1,23 @@
+{ Assignments that reuse their left-hand-side's address, e.g., a[i].x := a[i].x + 1 }
+program lvalue() is
+var
+	i, k : integer;
+	a : array [1..10] of integer;
+	r : array [0..4] of record x, y : integer end;
+begin
+	for i in 1..10 loop
+		a[i] := i
+	endloop;
+	for i in 1..10 loop
+		a[i] := a[i] * 2
+	endloop;
+	k := 2;
+	for i in 0..4 loop
+		r[i].x := i;
+		r[i].x := r[i].x + k;
+		r[i].y := r[i].x * r[i].x
+	endloop;
+	putln(a[10]);
+	putln(r[4].x);
+	putln(r[4].y)
+endprog
@@ -0,0 +1,36 @@
+{ Peephole optimizer patterns, compiled with -O and -O2 }
+program peephole() is
+var
+	i, j : integer;
+	r : real;
+	a : array [1..4] of integer;
+	p : record
+		x, y : integer
+	end;
+
+begin
+	i := 6;
+	j := i * 1 + 0;
+	putln(j);
+	j := i / 1 - 0;
+	putln(j);
+	r := i * 1.0;
+	putln(r);
+	r := r + 2;
+	putln(r);
+
+	a[3] := 7;
+	putln(a[3]);
+	p.y := 8;
+	putln(p.y);
+
+	if i = 6 then
+		if j = 5 then
+			putln(1)
+		else
+			putln(2)
+		endif
+	else
+		putln(3)
+	endif
+endprog
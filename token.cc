@@ -11,7 +11,13 @@
 
 #include "token.h"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 using namespace std;
@@ -20,175 +26,228 @@ using namespace std;
  *	Token 																						*
  ************************************************************************************************/
 
-// private:
-
-/// 'c' is unmodified if EOF is encounted on the input stream.
-std::istream& TokenStream::getch(char& c) {
-	if (col == line.size()) {
-		col = 0;
-		line.clear();
-		if (getline(*ip, line))
-			line.push_back('\n');
-	}
+// local
 
-	if (col < line.size())
-		c = line[col++];
+namespace {
+	/// Is c a decimal digit?
+	inline bool isDigit(char c)		{	return static_cast<unsigned char>(c - '0') < 10;				}
 
-	return *ip;
-}
+	/// Is c a letter, or an underscore?
+	inline bool isAlpha(char c)		{	return static_cast<unsigned char>((c | 0x20) - 'a') < 26 || '_' == c;	}
 
-std::istream& TokenStream::unget() {
-	if (col > 0) --col;
-	return *ip;
+	/// May c follow the first character of an identifier?
+	inline bool isIdent(char c)		{	return isAlpha(c) || isDigit(c);							}
 }
 
-/// Read and return the next token from the input stream
-Token TokenStream::get() {
-	char ch = 0;
+// private:
 
-	do {									// skip whitespace...
-		if (!getch(ch))
-			return ct = { Token::EOS };
+/// Scan and return the next token from the input stream
+const Token& TokenStream::scan() {
+	if (!loaded)
+		load();
 
-		if ('\n' == ch) ++lineNum;			// Count lines
+	for (;;) {								// skip whitespace...
+		if (cp == ep)
+			return ct = Token(Token::EOS);
 
-	} while (isspace(ch));
+		if ('\n' == *cp)
+			++lineNum;						// Count lines
+		else if (' ' != *cp && !isspace(static_cast<unsigned char>(*cp)))
+			break;
+		++cp;
+	}
 
+	const char ch = *cp++;
 	switch (ch) {
-	case '=': return ct.kind = Token::EQU;			break;
-	case '+': return ct.kind = Token::Add;			break;
-	case '-': return ct.kind = Token::Subtract;		break;
-	case '*': return ct.kind = Token::Multiply;		break;
-	case '/': return ct.kind = Token::Divide;		break;
-
-	case '(': return ct.kind = Token::OpenParen;	break;
-	case ')': return ct.kind = Token::CloseParen;	break;
-	case '[': return ct.kind = Token::OpenBrkt;		break;
-	case ']': return ct.kind = Token::CloseBrkt;	break;
-	case ',': return ct.kind = Token::Comma;		break;
-	case ';': return ct.kind = Token::SemiColon;	break;
-	case '`': return ct.kind = Token::Tick;			break;
-	case '^': return ct.kind = Token::Caret;		break;
+	case '=': ct.kind = Token::EQU;			break;
+	case '+':								// + or +=?
+		if (cp != ep && '=' == *cp)	{	++cp;	ct.kind = Token::AddAssign;	}
+		else								ct.kind = Token::Add;
+		break;
+
+	case '-':								// - or -=?
+		if (cp != ep && '=' == *cp)	{	++cp;	ct.kind = Token::SubtractAssign;	}
+		else								ct.kind = Token::Subtract;
+		break;
+
+	case '*':								// * or *=?
+		if (cp != ep && '=' == *cp)	{	++cp;	ct.kind = Token::MultiplyAssign;	}
+		else								ct.kind = Token::Multiply;
+		break;
+
+	case '/':								// / or /=?
+		if (cp != ep && '=' == *cp)	{	++cp;	ct.kind = Token::DivideAssign;	}
+		else								ct.kind = Token::Divide;
+		break;
+
+	case '(': ct.kind = Token::OpenParen;	break;
+	case ')': ct.kind = Token::CloseParen;	break;
+	case '[': ct.kind = Token::OpenBrkt;	break;
+	case ']': ct.kind = Token::CloseBrkt;	break;
+	case ',': ct.kind = Token::Comma;		break;
+	case ';': ct.kind = Token::SemiColon;	break;
+	case '`': ct.kind = Token::Tick;		break;
+	case '^': ct.kind = Token::Caret;		break;
 
 	case '>':								// >, or >=?
-		if (!getch(ch))		ct.kind = Token::GT;
-		else if ('=' == ch)	ct.kind = Token::GTE;
-		else {	unget();	ct.kind = Token::GT;	}
-		return ct;
+		if (cp != ep && '=' == *cp)	{	++cp;	ct.kind = Token::GTE;	}
+		else								ct.kind = Token::GT;
+		break;
 
 	case '<':								// <, <=, or <>?
-		if (!getch(ch))		ct.kind = Token::LT;
-		else if ('=' == ch)	ct.kind = Token::LTE;
-		else if ('>' == ch) ct.kind = Token::NEQ;
-		else {	unget();	ct.kind = Token::LT;	}
-		return ct;
+		if (cp != ep && '=' == *cp)			{	++cp;	ct.kind = Token::LTE;	}
+		else if (cp != ep && '>' == *cp)	{	++cp;	ct.kind = Token::NEQ;	}
+		else										ct.kind = Token::LT;
+		break;
 
 	case ':':								// : or :=?
-		if (!getch(ch))		ct.kind = Token::Colon;
-		else if ('=' == ch)	ct.kind = Token::Assign;
-		else {	unget();	ct.kind = Token::Colon;	}
-		return ct;
+		if (cp != ep && '=' == *cp)	{	++cp;	ct.kind = Token::Assign;	}
+		else								ct.kind = Token::Colon;
+		break;
 
 	case '{':								// comment; { ... }
 		ct.integer_value = lineNum;			// remember where the comment stated...
-		do {								// eat everthhing up to the closing '}'
-			if (!getch(ch)) {
+		for (;;) {							// eat everthhing up to the closing '}'
+			if (cp == ep) {
 				ct.kind = Token::BadComment;
 				return ct;
 			}
 
-			if ('\n' == ch)
+			const char c = *cp++;
+			if ('\n' == c)
 				++lineNum;					// keep counting lines...
-
-		} while ('}' != ch);
-		return get();						// restart the scan..
+			else if ('}' == c)
+				break;
+		}
+		return scan();						// restart the scan..
 
 	case '.': 								// '.', or '..'
-		if (!getch(ch))		ct.kind = Token::Period;
-		else if ('.' == ch)	ct.kind = Token::Ellipsis;
-		else {	unget();	ct.kind = Token::Period;	}
-		return ct;
+		if (cp != ep && '.' == *cp)	{	++cp;	ct.kind = Token::Ellipsis;	}
+		else								ct.kind = Token::Period;
+		break;
 											// integer or real number
 	case '0': case '1': case '2': case '3': case '4':
 	case '5': case '6': case '7': case '8': case '9': {
+		const char* begin = cp - 1;
+		long long value = ch - '0';
 		ct.kind = Token::IntegerNum;		// Assume integer value...
-		ct.string_value = ch;
-		while (getch(ch)) {
-			if ('.' == ch) {
-				if (Token::IntegerNum == ct.kind)
-					ct.kind = Token::RealNum;
-
-				else {						// Assuming '..' and not 'e.'
-					unget();
-					ct.string_value.pop_back();
-					ct.kind = Token::IntegerNum;
+		for (; cp != ep; ++cp) {
+			if ('.' == *cp) {				// A second '.', or '..', ends the number
+				if (Token::RealNum == ct.kind || (cp + 1 != ep && '.' == cp[1]))
 					break;
-				}
+				ct.kind = Token::RealNum;
 
-			} else if ('e' == ch || 'E' == ch)
+			} else if ('e' == *cp || 'E' == *cp)
 				ct.kind = Token::RealNum;
 
-			else if (!isdigit(ch))
+			else if (!isDigit(*cp))
 				break;
 
-			ct.string_value += ch;
+			else if (value <= numeric_limits<int>::max())
+				value = value * 10 + (*cp - '0');
 		}
-		unget();
 
-		std::istringstream iss (ct.string_value);
+		ct.string_value.assign(begin, cp);
 		if (Token::RealNum == ct.kind)
-			iss >> ct.real_value;
+			ct.real_value = strtod(ct.string_value.c_str(), nullptr);
+		else if (value > numeric_limits<int>::max())
+			ct.kind = Token::BadInteger;
 		else
-			iss >> ct.integer_value;
-		return ct;
+			ct.integer_value = static_cast<int>(value);
+		break;
 	}
 	
 	case '\'':								// Character literal
-		ct.string_value = "";
-		if (getch(ch))
-			ct.string_value += ch;
+		ct.string_value.clear();
+		if (cp != ep)
+			ct.string_value += *cp++;
 
-		getch(ch);							// just assume ch is a close quote
+		if (cp != ep)						// just assume it's a close quote
+			++cp;
 		ct.kind = Token::Character;
-		return ct;
-
-	case '"':								// String literal
-		ct.string_value = "";
-		while (getch(ch) && ch != '"')
-			ct.string_value += ch;
-
-		ct.kind = Token::String;			// Assume the ch is a close quote
-		return ct;
+		break;
+
+	case '"': {								// String literal
+		const char* begin = cp;
+		while (cp != ep && '"' != *cp)
+			++cp;
+
+		ct.string_value.assign(begin, cp);
+		if (cp != ep)						// Assume it's a close quote
+			++cp;
+		ct.kind = Token::String;
+		break;
+	}
 
 	default:								// ident, ident = or error
-		if (isalpha(ch) || ch == '_') {
-			ct.string_value = ch;
-			while (getch(ch) && (isalnum(ch) || ch == '_'))
-				ct.string_value += ch;
+		if (isAlpha(ch)) {
+			const char* begin = cp - 1;
+			uint32_t h = KeywordTable::hash(0, ch);
+			while (cp != ep && isIdent(*cp))
+				h = KeywordTable::hash(h, *cp++);
 
-			unget();
-			auto it = keywords.find(ct.string_value);
-			if (keywords.end() != it)
-				ct.kind = it->second;
-			else
-				ct.kind = Token::Identifier;
-			return ct;
+			ct.string_value.assign(begin, cp);
+			ct.kind = keywords.find(begin, cp - begin, h);
+			if (Token::Identifier == ct.kind)
+				ct.atom = Atom(ct.string_value);
 
 		} else {
 			ct.string_value = ch;
 			ct.integer_value = ch;
 			ct.kind = Token::Unknown;
-			return ct;
 		}
 	}
+
+	return ct;
 }
 
 /************************************************************************************************
  *	TokenStream
  ************************************************************************************************/
 
+// private
+
+/**
+ * Read the entire input stream into source. Seekable streams are read in one piece, others,
+ * e.g., a pipe, via their stream buffer.
+ */
+void TokenStream::load() {
+	source.clear();
+	if (ip->seekg(0, ios::end)) {
+		const streamoff size = ip->tellg();
+		ip->seekg(0, ios::beg);
+		if (size > 0) {
+			source.resize(static_cast<size_t>(size));
+			ip->read(&source[0], size);
+			source.resize(static_cast<size_t>(ip->gcount()));
+		}
+
+	} else {
+		ip->clear();
+		ostringstream oss;
+		oss << ip->rdbuf();
+		source = oss.str();
+	}
+
+	cp = source.data();
+	ep = cp + source.size();
+	loaded = true;
+}
+
 // public
 
+/// Read and return the next token from the input stream, timing the scan if timed
+const Token& TokenStream::get() {
+	++nTokens;
+	if (!timing)
+		return scan();
+
+	const auto start = chrono::steady_clock::now();
+	scan();
+	elapsed += chrono::steady_clock::now() - start;
+	return ct;
+}
+
 /**
  * Set the input stream to a reference to s.
  * @param	s	The new input stream
@@ -197,6 +256,7 @@ void TokenStream::set_input(std::istream& s) {
 	close();
 	ip = &s;
 	owns = false;
+	loaded = false;
 	lineNum = 1;
 }
 
@@ -208,9 +268,74 @@ void TokenStream::set_input(std::istream* p) {
 	close();
 	ip = p;
 	owns = true;
+	loaded = false;
 	lineNum = 1;
 }
 
+/************************************************************************************************
+ *	TokenStream::KeywordTable
+ ************************************************************************************************/
+
+/**
+ * Build a collision free table by searching for a multiplier that maps each keyword's hash to a
+ * unique slot. The table has at least eight slots per keyword, so a multiplier is quickly found.
+ *
+ * @param	keywords	The keywords, and their kinds
+ */
+TokenStream::KeywordTable::KeywordTable(initializer_list<Keyword> keywords)
+	: seed{0}, shift{32}, maxLen{0}
+{
+	size_t size = 1;
+	while (size < keywords.size() * 8) {
+		size *= 2;
+		--shift;
+	}
+
+	vector<uint32_t> hashes;
+	for (const auto& k : keywords) {
+		uint32_t h = 0;
+		for (const char* p = k.name; *p; ++p)
+			h = hash(h, *p);
+		hashes.push_back(h);
+		maxLen = max(maxLen, strlen(k.name));
+	}
+
+	for (uint32_t candidate = 0x9e3779b9; ; candidate = candidate * 1664525 + 1013904223) {
+		seed = candidate | 1;
+		slots.assign(size, Keyword { nullptr, Token::Identifier });
+
+		auto h = hashes.begin();
+		bool collision = false;
+		for (const auto& k : keywords) {
+			Keyword& slot = slots[this->slot(*h++)];
+			if (slot.name != nullptr) {
+				collision = true;
+				break;
+			}
+			slot = k;
+		}
+
+		if (!collision)
+			break;
+	}
+}
+
+/**
+ * @param	s	The identifier
+ * @param	len	The length of s
+ * @param	h	s's hash, per hash()
+ * @return	The kind of keyword s is, or Token::Identifier
+ */
+Token::Kind TokenStream::KeywordTable::find(const char* s, size_t len, uint32_t h) const {
+	if (len <= maxLen) {
+		const Keyword& k = slots[slot(h)];
+		if (k.name != nullptr && 0 == strncmp(k.name, s, len) && '\0' == k.name[len])
+			return k.kind;
+	}
+
+	return Token::Identifier;
+}
+
 // privite static
 
 TokenStream::KeywordTable	TokenStream::keywords = {
@@ -248,6 +373,7 @@ TokenStream::KeywordTable	TokenStream::keywords = {
 	{	"new",			Token::New			},
 	{	"odd",			Token::Odd			},
 	{	"of",			Token::Of			},
+	{	"or",			Token::Or			},
 	{	"ord",			Token::Ord			},
 	{	"program",		Token::ProgDecl		},
 	{	"procedure",	Token::ProcDecl		},
@@ -285,6 +411,7 @@ ostream& operator<<(std::ostream& os, const Token::Kind& kind) {
 	switch (kind) {
 	case Token::Unknown:	os << "unknown";		break;
 	case Token::BadComment:	os << "bad comment";	break;
+	case Token::BadInteger:	os << "bad integer";	break;
 
 	case Token::Identifier:	os << "identifier";		break;
 	case Token::Character:	os << "character";		break;
@@ -360,6 +487,10 @@ ostream& operator<<(std::ostream& os, const Token::Kind& kind) {
 	case Token::SemiColon:	os << ";";				break;
 	case Token::Tick:		os << "`";				break;
 	case Token::Assign:		os << ":=";				break;
+	case Token::AddAssign:		os << "+=";			break;
+	case Token::SubtractAssign:	os << "-=";			break;
+	case Token::MultiplyAssign:	os << "*=";			break;
+	case Token::DivideAssign:	os << "/=";			break;
 
 	case Token::Round:		os << "round";			break;
 	case Token::Trunc:		os << "trunc";			break;
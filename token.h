@@ -15,12 +15,17 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include "atom.h"
 #include "datum.h"
 
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
-#include <map>
 #include <sstream>
 #include <set>
+#include <string>
+#include <vector>
 
 /********************************************************************************************//**
  * A token "kind"/value pair
@@ -35,6 +40,7 @@ struct Token {
 	enum Kind {
 		Unknown,						///< Unknown token kind; (integer_value)
 		BadComment,						///< Unterminated comment, started at line # (integer_value)
+		BadInteger,						///< Integer literal that exceeds an Integer (string_value)
 
 		Identifier,	  		  			///< An identifier (string_value)
 		Character,						///< A single character, e.g., string_value[0] = 'c'
@@ -135,6 +141,10 @@ struct Token {
 		Dispose,						///< Free allocated dynamic store
 
 		Assign,							///< Assignment (:=)
+		AddAssign,						///< Add to (+=)
+		SubtractAssign,					///< Subtract from (-=)
+		MultiplyAssign,					///< Multiply by (*=)
+		DivideAssign,					///< Divide by (/=)
 		Mod,							///< Modulus (remainder)
 		Ord,							///< Convert ordinal value to ordinal
 
@@ -146,6 +156,7 @@ struct Token {
 
 	Kind			kind;				///< Token type
 	std::string		string_value;		///< kind == Identifier, or String or Character
+	Atom			atom;				///< kind == Identifier
 	int				integer_value;      ///< Kind == IntegerNum
 	double			real_value;			///< Kind == RealNum
 
@@ -162,45 +173,102 @@ struct Token {
  * Token streams may span multiple inputs; when the end of one input is seen, the current Token
  * is equal to end of stream (Kind::end), a new input source maybe set via set_input(); get()
  * will return the first Token of the new input.
+ *
+ * The input is read whole, on the first call to get(), and then scanned in place. Keywords are
+ * classified via a perfect hash of the identifier, computed as the identifier is scanned. The
+ * current token is reused, so it's string value only allocates when it outgrows it's capacity.
+ * As the input is retained, a position may be marked, and the stream later restored to it.
  ************************************************************************************************/
 class TokenStream {
 public:
+	/// A position in the input, from which scanning may be resumed
+	struct Mark {
+		const char*		cp;				///< The next character
+		size_t			lineNum;		///< It's line number
+		Token			ct;				///< The current token
+	};
+
 	size_t			lineNum;			///< Line # of the current stream
 
 	/// Initialize with an input stream which this does not own
-	TokenStream(std::istream& s) : lineNum{1}, ip{&s}, owns{false}, col{0}	{}
+	TokenStream(std::istream& s) : lineNum{1}, ip{&s}, owns{false}, loaded{false}	{}
 
 	/// Initialize with an input stream which this does own
-	TokenStream(std::istream* s) : lineNum{1}, ip{s}, owns{true}, col{0}	{}
+	TokenStream(std::istream* s) : lineNum{1}, ip{s}, owns{true}, loaded{false}	{}
 
 	/// Destructor
 	virtual ~TokenStream()				{	close();	}
 
-	/// Return the next character from the stream.
-	std::istream& getch(char& c);
-	std::istream& unget();				///< Return last character to the stream
+	const Token& get();					///< Read and return the next token...
+
+	/// Return the number of tokens read
+	size_t tokens() const				{	return nTokens;	}
 
-	Token get();
+	/// Time get(), accumulating time(), if on
+	void timed(bool on)					{	timing = on;	}
+
+	/// Return the time spent reading tokens, while timed
+	std::chrono::steady_clock::duration time() const	{	return elapsed;	}
 
 	/// The current token
 	Token& current() 					{	return ct;	}
 
+	/// Return the current position; only valid once the input has been read
+	Mark mark() const					{	return Mark { cp, lineNum, ct };	}
+
+	/// Resume scanning at m, a mark of the current input
+	void restore(const Mark& m)			{	cp = m.cp;	lineNum = m.lineNum;	ct = m.ct;	}
+
 	void set_input(std::istream& s);	///< Set the input stream to s
 	void set_input(std::istream* p);	///< Set the input stream to p
 
-private:								/// A map of keywords to their 'kind'
-	typedef	std::map<std::string, Token::Kind> KeywordTable;
+private:
+	/// A keyword and it's kind
+	struct Keyword {
+		const char*		name;			///< The keyword
+		Token::Kind		kind;			///< It's kind
+	};
+
+	/// A perfect hash table of keywords
+	class KeywordTable {
+	public:
+		KeywordTable(std::initializer_list<Keyword> keywords);
+
+		/// Hash a charater into h...
+		static uint32_t hash(uint32_t h, char c)	{	return h * 31 + static_cast<unsigned char>(c);	}
+
+		/// Return the kind of s[0..len), with hash h...
+		Token::Kind find(const char* s, size_t len, uint32_t h) const;
+
+	private:
+		std::vector<Keyword>	slots;	///< Keywords, indexed by slot()
+		uint32_t				seed;	///< Multiplier that makes slot() collision free
+		unsigned				shift;	///< 32 - log2(slots.size())
+		size_t					maxLen;	///< Length of the longest keyword
+
+		/// Return the slot index for hash h...
+		size_t slot(uint32_t h) const	{	return (h * seed) >> shift;	}
+	};
 
 	static	KeywordTable	keywords;	///< The keyword table
 
 	std::istream*	ip;					///< Pointer to an input stream
 	bool			owns;				///< Does *this* own ip?
-	size_t 			col;				///< Index into line for next character
-	std::string 	line;				///< last line read from the stream
+	bool			loaded;				///< Has *ip been read into source?
+	std::string		source;				///< The entire input
+	const char*		cp;					///< The next character in source
+	const char*		ep;					///< The end of source
 
 	/// The current token
 	Token 			ct { Token::EOS };
 
+	size_t			nTokens { 0 };		///< Number of tokens read
+	bool			timing { false };	///< Time get()?
+	std::chrono::steady_clock::duration elapsed { 0 };	///< Time spent in get(), while timed
+
+	void load();						///< Read *ip into source
+	const Token& scan();				///< Scan and return the next token...
+
 	/// If *this* owns ip, delete it.
 	void close()						{	if (owns) delete ip;	}
 };
@@ -5,6 +5,7 @@
  ****************************************************************************/
 
 #include <cassert>
+#include <functional>
 #include <limits>
 #include "type.h"
 
@@ -21,14 +22,14 @@ using namespace std;
  * @param	name	The fields name
  * @param	type	The fields type, e.g., "Integer" or "T"
  ****************************************************************************/
-Field::Field(const std::string& name, TDescPtr type)
+Field::Field(Atom name, TDescPtr type)
 	: _name{name}, _type{type} {
 }
 
 /********************************************************************************************//**
  * @return my fields name
  ************************************************************************************************/
-const std::string& Field::name() const			{	return _name;	}
+Atom Field::name() const						{	return _name;	}
 
 /********************************************************************************************//**
  * @return my fields type
@@ -70,13 +71,76 @@ bool operator==(const Field& lhs, const Field& rhs) {
  * @return	os 
  ************************************************************************************************/
 ostream& operator<<(std::ostream& os, const Field& field) {
-	return os << field.name() << ", " << field.type()->tclass();
+	os << field.name();
+	if (field.type() != nullptr)
+		os << ", " << field.type()->tclass();
+	return os;
 }
 
 /********************************************************************************************//**
  * TypeDesc
  ************************************************************************************************/
 
+// private static
+
+std::deque<TypeDesc>	TypeDesc::arena;
+TypeDesc::TypeTable		TypeDesc::table;
+
+/********************************************************************************************//**
+ * Combines the type class, size, range, ordinal and reference flags, and the addresses of the
+ * index, base and field types, which are interned themselves.
+ *
+ * @param	tdesc	The type descriptor to hash
+ * @return	tdesc's hash value
+ ************************************************************************************************/
+size_t TypeDesc::Hash::operator()(TDescPtr tdesc) const {
+	size_t h = static_cast<size_t>(tdesc->_tclass);
+	auto combine = [&h](size_t v) { h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2); };
+
+	combine(tdesc->_size);
+	combine(hash<int>()(tdesc->_range.min()));
+	combine(hash<int>()(tdesc->_range.max()));
+	combine(hash<TDescPtr>()(tdesc->_itype));
+	combine(hash<TDescPtr>()(tdesc->_base));
+	for (const auto& field : tdesc->_fields) {
+		combine(hash<Atom>()(field.name()));
+		combine(hash<TDescPtr>()(field.type()));
+	}
+	combine(tdesc->_ordinal);
+	combine(tdesc->_ref);
+
+	return h;
+}
+
+/********************************************************************************************//**
+ * @param	lhs	The left-hand side
+ * @param	rhs	The right-hand side
+ * @return	true if every member of lhs and rhs is equal.
+ ************************************************************************************************/
+bool TypeDesc::Equal::operator()(TDescPtr lhs, TDescPtr rhs) const {
+	return	lhs->_tclass	== rhs->_tclass		&&
+			lhs->_size		== rhs->_size		&&
+			lhs->_range		== rhs->_range		&&
+			lhs->_itype		== rhs->_itype		&&
+			lhs->_fields	== rhs->_fields		&&
+			lhs->_base		== rhs->_base		&&
+			lhs->_ordinal	== rhs->_ordinal	&&
+			lhs->_ref		== rhs->_ref;
+}
+
+/********************************************************************************************//**
+ * @param	tdesc	The type descriptor to intern
+ * @return	The interned descriptor equal to tdesc, adding a copy of tdesc if there is none
+ ************************************************************************************************/
+TDescPtr TypeDesc::intern(const TypeDesc& tdesc) {
+	auto it = table.find(&tdesc);
+	if (it != table.end())
+		return *it;
+
+	arena.push_back(tdesc);
+	return *table.insert(&arena.back()).first;
+}
+
 // protected:
 
 /**	Construct
@@ -121,7 +185,7 @@ const Subrange TypeDesc::maxRange(numeric_limits<int>::min(), numeric_limits<int
  * @return TDescPtr to a IntDesc
  ************************************************************************************************/
 TDescPtr TypeDesc::newIntDesc(const Subrange& range, bool ref) {
-	return TDescPtr(new TypeDesc(Integer,
+	return intern(TypeDesc(Integer,
 								1,
 								range,
 								TDescPtr(),
@@ -137,7 +201,7 @@ TDescPtr TypeDesc::newIntDesc(const Subrange& range, bool ref) {
  * @return TDescPtr to a new RealDesc
  ************************************************************************************************/
 TDescPtr TypeDesc::newRealDesc(bool ref) {
-	return TDescPtr(new TypeDesc(Real,
+	return intern(TypeDesc(Real,
 								1,
 								Subrange(),
 								TDescPtr(),
@@ -153,7 +217,7 @@ TDescPtr TypeDesc::newRealDesc(bool ref) {
  * @return TDescPtr to a new BoolDesc
  ************************************************************************************************/
 TDescPtr TypeDesc::newBoolDesc(bool ref) {
-	return TDescPtr(new TypeDesc(Boolean,
+	return intern(TypeDesc(Boolean,
 								1,
 								Subrange(0, 1),
 								TDescPtr(),
@@ -170,7 +234,7 @@ TDescPtr TypeDesc::newBoolDesc(bool ref) {
  * @return TDescPtr to a new CharDesc
  ************************************************************************************************/
 TDescPtr TypeDesc::newCharDesc(const Subrange& range, bool ref) {
-	return TDescPtr(new TypeDesc(Character,
+	return intern(TypeDesc(Character,
 								1,
 								range,
 								TDescPtr(),
@@ -196,7 +260,7 @@ TDescPtr TypeDesc::newArrayDesc(
 			TDescPtr	base,
 			bool		ref)
 {
-	return TDescPtr(new TypeDesc(Array, size, range, itype, FieldVec(), base, false, ref));
+	return intern(TypeDesc(Array, size, range, itype, FieldVec(), base, false, ref));
 }
 
 /********************************************************************************************//**
@@ -207,7 +271,7 @@ TDescPtr TypeDesc::newArrayDesc(
  * @return TDescPtr to a new RecordDesc
  ************************************************************************************************/
 TDescPtr TypeDesc::newRcrdDesc(size_t size, const FieldVec& fields, bool ref) {
-	return TDescPtr(new TypeDesc(Record,
+	return intern(TypeDesc(Record,
 								size,
 								Subrange(),
 								TDescPtr(),
@@ -225,7 +289,7 @@ TDescPtr TypeDesc::newRcrdDesc(size_t size, const FieldVec& fields, bool ref) {
  * @return TDescPtr to a new EnumDesc
  ************************************************************************************************/
 TDescPtr TypeDesc::newEnumDesc(const Subrange& range, const FieldVec& fields, bool ref) {
-	return TDescPtr(new TypeDesc(Enumeration,
+	return intern(TypeDesc(Enumeration,
 								1,
 								range,
 								TDescPtr(),
@@ -242,7 +306,7 @@ TDescPtr TypeDesc::newEnumDesc(const Subrange& range, const FieldVec& fields, bo
  * @return TDescPtr to a new PtrDesc
  ************************************************************************************************/
 TDescPtr TypeDesc::newPointerDesc(TDescPtr base, bool ref) {
-	return TDescPtr(new TypeDesc(Pointer,
+	return intern(TypeDesc(Pointer,
 								1,
 								Subrange(),
 								TDescPtr(),
@@ -253,13 +317,24 @@ TDescPtr TypeDesc::newPointerDesc(TDescPtr base, bool ref) {
 }
 
 /********************************************************************************************//**
- * @param	tdesc		The type descriptor to clone
- * @return	TDescPtr to a new copy of tdesc
+ * @param	tdesc		The type descriptor
+ * @param	ref			Type is passed by reference
+ * @return	TDescPtr to tdesc, passed by reference if ref is true
  ************************************************************************************************/
-TDescPtr TypeDesc::clone(TDescPtr tdesc) {
-	return TDescPtr(new TypeDesc(*tdesc));
+TDescPtr TypeDesc::newRefDesc(TDescPtr tdesc, bool ref) {
+	if (tdesc->_ref == ref)
+		return tdesc;
+
+	TypeDesc copy(*tdesc);
+	copy._ref = ref;
+	return intern(copy);
 }
 
+/********************************************************************************************//**
+ * @return the number of distinct types created so far
+ ************************************************************************************************/
+size_t TypeDesc::nTypes()						{	return arena.size();			}
+
 // public
 
 /********************************************************************************************//**
@@ -272,11 +347,6 @@ TypeDesc::TypeClass TypeDesc::tclass() const	{	return _tclass;					}
  ************************************************************************************************/
 size_t TypeDesc::size() const					{	return _size;					}
 
-/********************************************************************************************//**
- * @return my size, in Datums
- ************************************************************************************************/
-size_t TypeDesc::size(size_t sz) 				{	return _size = sz;				}
-
 /********************************************************************************************//**
  * @return my sub-range
  ************************************************************************************************/
@@ -287,34 +357,16 @@ const Subrange& TypeDesc::range() const 		{	return _range;					}
  ************************************************************************************************/
 TDescPtr TypeDesc::itype() const 				{	return _itype;					}
 
-/********************************************************************************************//**
- * @return my index type
- ************************************************************************************************/
-TDescPtr TypeDesc::itype(TDescPtr type) 		{	return _itype = type;			}
-
 /********************************************************************************************//**
  * @return my fields
  ************************************************************************************************/
 const FieldVec& TypeDesc::fields() const		{	return _fields;					}
 
-/********************************************************************************************//**
- * @return my fields
- ************************************************************************************************/
-const FieldVec& TypeDesc::fields(const FieldVec& fields) {
-	return _fields = fields;
-}
-
 /********************************************************************************************//**
  * @return by base type
  ************************************************************************************************/
 TDescPtr TypeDesc::base() const 				{	return _base;					}
 
-/********************************************************************************************//**
- * @param	type	My new base type
- * @return type
- ************************************************************************************************/
-TDescPtr TypeDesc::base(TDescPtr type)			{	return _base = type;			}
-
 /********************************************************************************************//**
  * @return true if my type is ordinal
  ************************************************************************************************/
@@ -325,12 +377,6 @@ bool TypeDesc::ordinal() const 					{	return _ordinal;				}
  ************************************************************************************************/
 bool TypeDesc::ref() const						{	return _ref;					}
 
-/********************************************************************************************//**
- * @param	r	True if my type is passed by refernce
- * @return	r
- ************************************************************************************************/
-bool TypeDesc::ref(bool r)						{	return _ref = r;				}
-
 // operators
 
 /********************************************************************************************//**
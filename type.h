@@ -10,25 +10,30 @@
 #ifndef	TYPE_H
 #define	TYPE_H
 
+#include <deque>
 #include <iostream>
 #include <string>
-#include <memory>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "atom.h"
 #include "subrange.h"
 
 class TypeDesc; 
 
 /********************************************************************************************//**
- * Pointer to a TypeDesc
+ * Pointer to an interned TypeDesc
+ *
+ * TypeDesc's are immutable and interned, so two TDescPtr's are equal if, and only if, they
+ * describe the same type.
  ************************************************************************************************/
-typedef std::shared_ptr<TypeDesc>		TDescPtr;
+typedef const TypeDesc*					TDescPtr;
 
 /********************************************************************************************//**
  * Pointer to a const TypeDesc
  ************************************************************************************************/
-typedef std::shared_ptr<const TypeDesc>	ConstTDescPtr;
+typedef const TypeDesc*					ConstTDescPtr;
 
 /********************************************************************************************//**
  * Vector of TDescPtr
@@ -39,19 +44,19 @@ typedef std::vector<TDescPtr>			TDescPtrVec;
  * Type Field - record field name and type pair
  ************************************************************************************************/
 class Field {
-	std::string	_name;					///< The fields name
+	Atom		_name;					///< The fields name
 	TDescPtr	_type;					///< The fields type
 
 public:
 	Field() {}							///< Default constructor
-	Field(const std::string& name, TDescPtr type);
+	Field(Atom name, TDescPtr type);
 	virtual ~Field() {}					///< Destructor
 
-	const std::string& name() const;	///< Return the field name
+	Atom name() const;					///< Return the field name
 	TDescPtr type() const;				///< Return the field type
 
 	/// Set my name...
-	void name(const std::string& name) {
+	void name(Atom name) {
 		_name = name;
 	}
 };
@@ -85,7 +90,12 @@ typedef std::vector<Field>	FieldVec;
  * Key:
  * - IType - is the sub-range (index) type for arrays
  * - Base - is the base type for arrays, sub-ranges and enumerations
- * - Fields - is a list of name/type pairs to identify record fields
+ * - Fields - is a list of name/type pairs to identify record fields, or the names of an
+ *   enumerations values, whose types are null
+ *
+ * Type descriptors are created by the newXxxDesc() factories, which intern them by structure in
+ * an arena that lives as long as the program; creating a type that already exists returns the
+ * existing descriptor.
  ************************************************************************************************/
 class TypeDesc {
 public:
@@ -135,26 +145,20 @@ public:
 	/// Create, and return, a TDescPtr to a new PointerDesc
 	static TDescPtr newPointerDesc(TDescPtr base, bool ref = false);
 
-	/// Return a new copy of a TypeDesc
-	static TDescPtr clone(TDescPtr tdesc);
+	/// Return tdesc, passed by reference if ref is true, by value otherwise
+	static TDescPtr newRefDesc(TDescPtr tdesc, bool ref);
+
+	static size_t nTypes();				///< Return the number of interned types
 
 	virtual ~TypeDesc() {}				///< Destructor
 
 	TypeClass tclass() const;			///< Return my type class
 	size_t size() const;				///< Return my size, in Datums
-	size_t size(size_t sz); 			///< Set, and then return, my size in Datums
 	const Subrange& range() const;		///< Return my sub-range
 	TDescPtr itype() const;				///< Return my array sub-rane (index) type. 
-	TDescPtr itype(TDescPtr type);		///< Set, and then return, my range type
 	const FieldVec& fields() const;		///< Return my fields
-
-	/// Return my fields
-	const FieldVec& fields(const FieldVec& fields);
-
 	TDescPtr base() const;				///< Return by base type
-	TDescPtr base(TDescPtr type);		///< Set, and then return, my base type
 	bool ordinal() const;				///< Return true if I'm an ordinal
-	bool ref(bool v);					///< Set, and then return, if this type is passed by reference
 	bool ref() const;					///< Return true if this type is passed by reference
 
 protected:
@@ -169,6 +173,25 @@ protected:
 				bool		ref		= false);
 
 private:
+	/// Hash a type descriptor by structure
+	struct Hash {
+		size_t operator()(TDescPtr tdesc) const;
+	};
+
+	/// Compare type descriptors by structure
+	struct Equal {
+		bool operator()(TDescPtr lhs, TDescPtr rhs) const;
+	};
+
+	/// Interned type descriptors
+	typedef std::unordered_set<TDescPtr, Hash, Equal> TypeTable;
+
+	static std::deque<TypeDesc>	arena;		///< Storage for the interned type descriptors
+	static TypeTable			table;		///< The interned type descriptors
+
+	/// Return the interned copy of tdesc
+	static TDescPtr intern(const TypeDesc& tdesc);
+
 	TypeClass	_tclass;					///< Type class
 	size_t		_size;						///< Size, in Datums
 	Subrange	_range;						///< My sub-range. For arrays, the array's span
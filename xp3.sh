@@ -0,0 +1,11 @@
+#!/bin/bash
+for i in $( ls test3/*.p ); do
+	s=$(basename $i)
+	./p -O2 -l $i &> objs/$s.lst
+	cmp objs/$s.lst $i.lst
+	if [ "$?" != "0" ]; then
+		diff objs/$s.lst $i.lst
+		exit
+	fi
+done
+
@@ -0,0 +1,16 @@
+#!/bin/bash
+# Compile each test to a .pbc file, and compare it's run with that of the source
+for i in $( ls test/*.p ); do
+	s=$(basename $i .p)
+	cp $i objs/$s.p
+	./p $i &> objs/$s.out
+	./p -c objs/$s.p &> /dev/null
+	if [ -f objs/$s.pbc ]; then
+		./p objs/$s.pbc &> objs/$s.pbc.out
+		cmp objs/$s.out objs/$s.pbc.out
+		if [ "$?" != "0" ]; then
+			diff objs/$s.out objs/$s.pbc.out
+			exit
+		fi
+	fi
+done
@@ -0,0 +1,15 @@
+#!/bin/bash
+# Run each test on the register machine, and compare it's run with that of the stack machine.
+# The register machine's stack depth differs, so sp isn't compared.
+for i in $( ls test/*.p test2/*.p ); do
+	s=$(basename $i .p)
+	in=/dev/null
+	[ -f ${i%.p}.in ] && in=${i%.p}.in
+	./p $i < $in 2>&1 | sed 's/sp: [0-9]*/sp: -/' > objs/$s.out
+	./p -R $i < $in 2>&1 | sed 's/sp: [0-9]*/sp: -/' > objs/$s.reg.out
+	cmp objs/$s.out objs/$s.reg.out
+	if [ "$?" != "0" ]; then
+		diff objs/$s.out objs/$s.reg.out
+		exit
+	fi
+done
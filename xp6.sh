@@ -0,0 +1,15 @@
+#!/bin/bash
+# Run each test with every procedure compiled to native code, and compare it's run, including
+# the number of machine cycles, with that of the interpreter.
+for i in $( ls test/*.p test2/*.p ); do
+	s=$(basename $i .p)
+	in=/dev/null
+	[ -f ${i%.p}.in ] && in=${i%.p}.in
+	./p -v $i < $in > objs/$s.out 2>&1
+	P_JIT_HOT=1 ./p -v -J $i < $in 2>&1 | grep -av 'procedures to native code' > objs/$s.jit.out
+	cmp objs/$s.out objs/$s.jit.out
+	if [ "$?" != "0" ]; then
+		diff objs/$s.out objs/$s.jit.out
+		exit
+	fi
+done
@@ -0,0 +1,25 @@
+#!/bin/bash
+# Translate each test to C++, build it with libp.a, and compare it's run, including it's exit
+# status, with that of the interpreter.
+make -s libp.a || exit
+for i in $( ls test/*.p test2/*.p ); do
+	s=$(basename $i .p)
+	in=/dev/null
+	[ -f ${i%.p}.in ] && in=${i%.p}.in
+	./p $i < $in > objs/$s.out 2>&1
+	echo "exit $?" >> objs/$s.out
+	cp $i objs/$s.p
+	./p --emit-cpp objs/$s.p > objs/$s.emit.out 2>&1
+	if [ "$?" != "0" ]; then
+		grep "can't" objs/$s.emit.out && exit
+		continue						# compile errors; nothing to run
+	fi
+	c++ -std=c++11 -I. -o objs/$s.native objs/$s.cc libp.a || exit
+	objs/$s.native < $in > objs/$s.native.out 2>&1
+	echo "exit $?" >> objs/$s.native.out
+	cmp objs/$s.out objs/$s.native.out
+	if [ "$?" != "0" ]; then
+		diff objs/$s.out objs/$s.native.out
+		exit
+	fi
+done
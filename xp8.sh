@@ -0,0 +1,25 @@
+#!/bin/bash
+# Run each test to write a profile, and compare it's run with that of the interpreter, then
+# compare the run of it's profile guided compilation, less any error addresses, with that of -O2.
+for i in $( ls test/*.p test2/*.p ); do
+	s=$(basename $i .p)
+	in=/dev/null
+	[ -f ${i%.p}.in ] && in=${i%.p}.in
+	./p $i < $in > objs/$s.out 2>&1
+	rm -f objs/$s.prof
+	./p --profile-generate=objs/$s.prof $i < $in > objs/$s.prof.out 2>&1
+	cmp objs/$s.out objs/$s.prof.out
+	if [ "$?" != "0" ]; then
+		diff objs/$s.out objs/$s.prof.out
+		exit
+	fi
+
+	[ -f objs/$s.prof ] || continue			# Didn't compile
+	./p -O2 $i < $in 2>&1 | grep -av '@ *pc' > objs/$s.O2.out
+	./p -O2 --profile-use=objs/$s.prof $i < $in 2>&1 | grep -av '@ *pc' > objs/$s.pgo.out
+	cmp objs/$s.O2.out objs/$s.pgo.out
+	if [ "$?" != "0" ]; then
+		diff objs/$s.O2.out objs/$s.pgo.out
+		exit
+	fi
+done
@@ -0,0 +1,16 @@
+#!/bin/bash
+# Compare each test's run, less any error addresses, with that of it's lazy compilation. Tests
+# that don't compile are skipped, as errors in deferred subroutines are reported when called.
+for i in $( ls test/*.p test2/*.p ); do
+	s=$(basename $i .p)
+	in=/dev/null
+	[ -f ${i%.p}.in ] && in=${i%.p}.in
+	./p $i < $in 2>&1 | grep -av '@ *pc' > objs/$s.out
+	grep -qa 'near line' objs/$s.out && continue
+	./p --lazy $i < $in 2>&1 | grep -av '@ *pc' > objs/$s.lazy.out
+	cmp objs/$s.out objs/$s.lazy.out
+	if [ "$?" != "0" ]; then
+		diff objs/$s.out objs/$s.lazy.out
+		exit
+	fi
+done